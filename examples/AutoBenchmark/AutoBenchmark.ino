@@ -39,6 +39,10 @@ SOFTWARE.
 #include <ace_spi/HardSpiFastInterface.h>
 #endif
 
+#if defined(ESP32)
+#include <soc/spi_struct.h> // spi_dev_t, SPI3
+#endif
+
 using namespace ace_spi;
 using ace_common::TimingStats;
 
@@ -46,6 +50,17 @@ using ace_common::TimingStats;
 #define SERIAL_PORT_MONITOR Serial
 #endif
 
+// The ATtiny25/45/85 has only 128-512 bytes of RAM and 6 I/O pins, so only the
+// benchmarks of the USI and software interfaces, without the pixel rows, are
+// compiled for it.
+#if defined(__AVR_ATtiny25__) \
+    || defined(__AVR_ATtiny45__) \
+    || defined(__AVR_ATtiny85__)
+  #define BENCHMARK_ATTINY 1
+#else
+  #define BENCHMARK_ATTINY 0
+#endif
+
 //------------------------------------------------------------------
 // Setup for SPI parameters.
 //------------------------------------------------------------------
@@ -58,12 +73,21 @@ const uint8_t CLOCK_PIN = SCK;
 // Run benchmarks.
 //------------------------------------------------------------------
 
-/** Print the result for each LedMatrix algorithm. */
+/**
+ * Print the result of a benchmark. The name of the benchmark is the name of the
+ * interface, followed by an optional comma-separated variant.
+ */
 static void printStats(
     const __FlashStringHelper* name,
+    const __FlashStringHelper* variant,
     const TimingStats& stats,
-    uint16_t numSamples) {
+    uint16_t numSamples,
+    uint16_t numBytes) {
   SERIAL_PORT_MONITOR.print(name);
+  if (variant) {
+    SERIAL_PORT_MONITOR.print(',');
+    SERIAL_PORT_MONITOR.print(variant);
+  }
   SERIAL_PORT_MONITOR.print(' ');
   SERIAL_PORT_MONITOR.print(stats.getMin());
   SERIAL_PORT_MONITOR.print(' ');
@@ -71,18 +95,30 @@ static void printStats(
   SERIAL_PORT_MONITOR.print(' ');
   SERIAL_PORT_MONITOR.print(stats.getMax());
   SERIAL_PORT_MONITOR.print(' ');
-  SERIAL_PORT_MONITOR.println(numSamples);
+  SERIAL_PORT_MONITOR.print(numSamples);
+  SERIAL_PORT_MONITOR.print(' ');
+  SERIAL_PORT_MONITOR.println(numBytes);
 }
 
 TimingStats timingStats;
 
+// Number of samples of each benchmark.
+const uint16_t NUM_SAMPLES = 20;
+
+// 16 (register, value) pairs, emulating the refresh of 8 digits on 2
+// MAX7219 modules.
+const uint8_t REGISTERS[] = {
+  0x01, 0x11, 0x02, 0x22, 0x03, 0x33, 0x04, 0x44,
+  0x05, 0x55, 0x06, 0x66, 0x07, 0x77, 0x08, 0x88,
+  0x01, 0x99, 0x02, 0xaa, 0x03, 0xbb, 0x04, 0xcc,
+  0x05, 0xdd, 0x06, 0xee, 0x07, 0xff, 0x08, 0x00,
+};
+
+/** Send 8 bytes using 8 transactions, emulating an LED module with 8 digits. */
 template <typename T_SPII>
-void runBenchmark(const __FlashStringHelper* name, T_SPII& spiInterface) {
-  // Sample 20 times.
-  uint16_t numSamples = 20;
+void runSend8(const __FlashStringHelper* name, T_SPII& spiInterface) {
   timingStats.reset();
-  for (uint16_t i = 0; i < numSamples; i++) {
-    // Send 8 bytes, emulating an LED module with 8 digits.
+  for (uint16_t i = 0; i < NUM_SAMPLES; i++) {
     uint16_t startMicros = micros();
     spiInterface.send8(0x11);
     spiInterface.send8(0x22);
@@ -97,9 +133,786 @@ void runBenchmark(const __FlashStringHelper* name, T_SPII& spiInterface) {
     yield();
   }
 
-  printStats(name, timingStats, numSamples);
+  printStats(name, nullptr, timingStats, NUM_SAMPLES, 8);
+}
+
+/** Send the same 8 bytes in a single transaction using variadic send(). */
+template <typename T_SPII>
+void runSend(const __FlashStringHelper* name, T_SPII& spiInterface) {
+  timingStats.reset();
+  for (uint16_t i = 0; i < NUM_SAMPLES; i++) {
+    uint16_t startMicros = micros();
+    spiInterface.send(0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88);
+    uint16_t endMicros = micros();
+    timingStats.update(endMicros - startMicros);
+    yield();
+  }
+
+  printStats(name, F("send()"), timingStats, NUM_SAMPLES, 8);
+}
+
+/** Send numPairs register pairs using one send16() per pair. */
+template <typename T_SPII>
+void runSend16(
+    const __FlashStringHelper* name,
+    const __FlashStringHelper* variant,
+    T_SPII& spiInterface,
+    uint8_t numPairs) {
+  timingStats.reset();
+  for (uint16_t i = 0; i < NUM_SAMPLES; i++) {
+    uint16_t startMicros = micros();
+    const uint8_t* pairs = REGISTERS;
+    for (uint8_t j = 0; j < numPairs; j++) {
+      spiInterface.send16(pairs[0], pairs[1]);
+      pairs += 2;
+    }
+    uint16_t endMicros = micros();
+    timingStats.update(endMicros - startMicros);
+    yield();
+  }
+
+  printStats(name, variant, timingStats, NUM_SAMPLES, numPairs * 2);
+}
+
+/** Send numPairs register pairs using a single sendRegisters(). */
+template <typename T_SPII>
+void runSendRegisters(
+    const __FlashStringHelper* name,
+    const __FlashStringHelper* variant,
+    T_SPII& spiInterface,
+    uint8_t numPairs) {
+  timingStats.reset();
+  for (uint16_t i = 0; i < NUM_SAMPLES; i++) {
+    uint16_t startMicros = micros();
+    spiInterface.sendRegisters(REGISTERS, numPairs);
+    uint16_t endMicros = micros();
+    timingStats.update(endMicros - startMicros);
+    yield();
+  }
+
+  printStats(name, variant, timingStats, NUM_SAMPLES, numPairs * 2);
+}
+
+#if ! BENCHMARK_ATTINY
+
+// Width and height of an RGB565 frame of a 128x160 TFT (e.g. ST7735).
+const uint16_t FRAME_WIDTH = 128;
+const uint16_t FRAME_HEIGHT = 160;
+
+// Size of the frame queued to each device.
+const uint8_t FRAME_SIZE = 32;
+
+// Number of devices which receive the same frame.
+const uint8_t NUM_QUEUED_DEVICES = 4;
+
+// Size of the frame of an offset-addressed device, e.g. a 64-channel LED
+// driver.
+const uint16_t DELTA_FRAME_SIZE = 64;
+
+// Number of LEDs of the largest APA102 strip. The LED strip benchmarks do not
+// run on AVR processors.
+#if ! defined(ARDUINO_ARCH_AVR)
+const uint16_t APA102_MAX_LEDS = 1000;
+#endif
+
+/**
+ * The input buffers of each group of benchmarks. Each group initializes its
+ * own buffers before it runs, or does not depend on their contents, so all
+ * groups share the same RAM. On the ATmega328P, this saves about 700 bytes of
+ * its 2 kB of RAM, which leaves room on the stack for the framebuffer of the
+ * OLED benchmarks.
+ */
+union ScratchBuffers {
+  // One row of RGB565 pixels of the frame.
+  uint16_t pixelRow[FRAME_WIDTH];
+
+  // The frame queued to each device, and the per-request buffers, one for
+  // each device.
+  struct {
+    uint8_t frame[FRAME_SIZE];
+    uint8_t requestBuffers[NUM_QUEUED_DEVICES][FRAME_SIZE];
+  } queue;
+
+  // One row of the frame as 8-bit palette indexes, and as packed RGB888
+  // triples.
+  struct {
+    uint8_t paletteRow[FRAME_WIDTH];
+    uint8_t rgb888Row[FRAME_WIDTH * 3];
+  } rows;
+
+  // The FrameDeltaEncoder alternates between these 2 frames, which differ in
+  // the bytes selected by the benchmark.
+  struct {
+    uint8_t frameA[DELTA_FRAME_SIZE];
+    uint8_t frameB[DELTA_FRAME_SIZE];
+  } delta;
+
+#if ! defined(ARDUINO_ARCH_AVR)
+  // RGB888 pixels of the APA102 and WS2812 LED strips.
+  uint8_t apa102Pixels[APA102_MAX_LEDS * 3];
+#endif
+};
+
+ScratchBuffers scratch;
+
+/**
+ * Send a full 128x160 RGB565 frame, one row per transaction, using one
+ * transfer16() per pixel. Each row is one sample, so the time of the full frame
+ * is FRAME_HEIGHT times the average.
+ */
+template <typename T_SPII>
+void runPixelsTransfer16(
+    const __FlashStringHelper* name,
+    T_SPII& spiInterface) {
+  timingStats.reset();
+  for (uint16_t i = 0; i < FRAME_HEIGHT; i++) {
+    uint16_t startMicros = micros();
+    spiInterface.beginTransaction();
+    for (uint16_t j = 0; j < FRAME_WIDTH; j++) {
+      spiInterface.transfer16(scratch.pixelRow[j]);
+    }
+    spiInterface.endTransaction();
+    uint16_t endMicros = micros();
+    timingStats.update(endMicros - startMicros);
+    yield();
+  }
+
+  printStats(name, F("transfer16()x128"), timingStats, FRAME_HEIGHT,
+      FRAME_WIDTH * 2);
+}
+
+/**
+ * Send a full 128x160 RGB565 frame, one row per transaction, using a single
+ * transfer16Array() per row.
+ */
+template <typename T_SPII>
+void runPixelsTransfer16Array(
+    const __FlashStringHelper* name,
+    T_SPII& spiInterface) {
+  timingStats.reset();
+  for (uint16_t i = 0; i < FRAME_HEIGHT; i++) {
+    uint16_t startMicros = micros();
+    spiInterface.beginTransaction();
+    spiInterface.transfer16Array(scratch.pixelRow, FRAME_WIDTH);
+    spiInterface.endTransaction();
+    uint16_t endMicros = micros();
+    timingStats.update(endMicros - startMicros);
+    yield();
+  }
+
+  printStats(name, F("transfer16Array(128)"), timingStats, FRAME_HEIGHT,
+      FRAME_WIDTH * 2);
+}
+
+#endif
+
+// Number of bytes of the generated pattern.
+const uint8_t GENERATED_SIZE = 64;
+
+/** Return the i-th byte of a generated test pattern. */
+static uint8_t generatePattern(uint8_t i) {
+  return (uint8_t) (i * 7) ^ (i >> 3);
+}
+
+/**
+ * Generate the 64-byte pattern into a buffer, then send the buffer in a single
+ * transaction.
+ */
+template <typename T_SPII>
+void runSendBuffered(const __FlashStringHelper* name, T_SPII& spiInterface) {
+  timingStats.reset();
+  for (uint16_t i = 0; i < NUM_SAMPLES; i++) {
+    uint16_t startMicros = micros();
+    uint8_t buffer[GENERATED_SIZE];
+    for (uint8_t j = 0; j < GENERATED_SIZE; j++) {
+      buffer[j] = generatePattern(j);
+    }
+    spiInterface.beginTransaction();
+    for (uint8_t j = 0; j < GENERATED_SIZE; j++) {
+      spiInterface.transfer(buffer[j]);
+    }
+    spiInterface.endTransaction();
+    uint16_t endMicros = micros();
+    timingStats.update(endMicros - startMicros);
+    yield();
+  }
+
+  printStats(name, F("buffered(64)"), timingStats, NUM_SAMPLES,
+      GENERATED_SIZE);
+}
+
+/** Send the same 64-byte pattern using sendGenerated(), without a buffer. */
+template <typename T_SPII>
+void runSendGenerated(const __FlashStringHelper* name, T_SPII& spiInterface) {
+  timingStats.reset();
+  for (uint16_t i = 0; i < NUM_SAMPLES; i++) {
+    uint16_t startMicros = micros();
+    uint8_t j = 0;
+    spiInterface.sendGenerated(
+        [&j]() { return generatePattern(j++); },
+        GENERATED_SIZE);
+    uint16_t endMicros = micros();
+    timingStats.update(endMicros - startMicros);
+    yield();
+  }
+
+  printStats(name, F("sendGenerated(64)"), timingStats, NUM_SAMPLES,
+      GENERATED_SIZE);
+}
+
+/** Run all benchmarks on the given interface. */
+template <typename T_SPII>
+void runBenchmark(const __FlashStringHelper* name, T_SPII& spiInterface) {
+  runSend8(name, spiInterface);
+  runSend(name, spiInterface);
+  runSend16(name, F("send16()x8"), spiInterface, 8);
+  runSendRegisters(name, F("sendRegisters(8)"), spiInterface, 8);
+  runSend16(name, F("send16()x16"), spiInterface, 16);
+  runSendRegisters(name, F("sendRegisters(16)"), spiInterface, 16);
+#if ! BENCHMARK_ATTINY
+  runPixelsTransfer16(name, spiInterface);
+  runPixelsTransfer16Array(name, spiInterface);
+#endif
+  runSendBuffered(name, spiInterface);
+  runSendGenerated(name, spiInterface);
+}
+
+#if ! BENCHMARK_ATTINY
+
+//-----------------------------------------------------------------------------
+// Multicast benchmarks
+//-----------------------------------------------------------------------------
+
+#if defined(ARDUINO_ARCH_AVR) || defined(EPOXY_DUINO)
+
+// Latch pins of up to 8 identical devices. On the Nano, pins 2-7 are on PORTD,
+// so 2 and 4 targets are selected using a single port write, but 8 targets
+// span PORTD and PORTB and are selected using digitalWrite().
+const uint8_t MULTICAST_LATCH_PINS[] = {2, 3, 4, 5, 6, 7, 8, 9};
+
+/**
+ * Send the same 8 bytes to numTargets devices, one transaction per device.
+ * The number of bytes is the number of bytes received by all devices.
+ */
+void runUnicastSend(
+    const __FlashStringHelper* variant,
+    uint8_t numTargets) {
+  timingStats.reset();
+  for (uint16_t i = 0; i < NUM_SAMPLES; i++) {
+    uint16_t startMicros = micros();
+    for (uint8_t j = 0; j < numTargets; j++) {
+      HardSpiInterface<SPIClass> spiInterface(SPI, MULTICAST_LATCH_PINS[j]);
+      spiInterface.send(0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88);
+    }
+    uint16_t endMicros = micros();
+    timingStats.update(endMicros - startMicros);
+    yield();
+  }
+
+  printStats(F("HardSpiInterface"), variant, timingStats, NUM_SAMPLES,
+      numTargets * 8);
+}
+
+/**
+ * Send the same 8 bytes to numTargets devices in a single multicast
+ * transaction. The number of bytes is the number of bytes received by all
+ * devices.
+ */
+void runMulticastSend(
+    const __FlashStringHelper* variant,
+    uint8_t numTargets) {
+  using SpiInterface = HardSpiMulticastInterface<SPIClass>;
+  SpiInterface spiInterface(SPI, MULTICAST_LATCH_PINS, numTargets);
+  spiInterface.begin();
+
+  timingStats.reset();
+  for (uint16_t i = 0; i < NUM_SAMPLES; i++) {
+    uint16_t startMicros = micros();
+    spiInterface.send(0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77, 0x88);
+    uint16_t endMicros = micros();
+    timingStats.update(endMicros - startMicros);
+    yield();
+  }
+
+  printStats(F("HardSpiMulticastInterface"), variant, timingStats, NUM_SAMPLES,
+      numTargets * 8);
+}
+
+void runMulticast() {
+  SPI.begin();
+  for (uint8_t j = 0; j < sizeof(MULTICAST_LATCH_PINS); j++) {
+    digitalWrite(MULTICAST_LATCH_PINS[j], HIGH);
+    pinMode(MULTICAST_LATCH_PINS[j], OUTPUT);
+  }
+
+  runUnicastSend(F("send()x2"), 2);
+  runUnicastSend(F("send()x4"), 4);
+  runUnicastSend(F("send()x8"), 8);
+  runMulticastSend(F("send()x2"), 2);
+  runMulticastSend(F("send()x4"), 4);
+  runMulticastSend(F("send()x8"), 8);
+
+  for (uint8_t j = 0; j < sizeof(MULTICAST_LATCH_PINS); j++) {
+    pinMode(MULTICAST_LATCH_PINS[j], INPUT);
+  }
+}
+
+#endif
+
+//-----------------------------------------------------------------------------
+// Payload queuing benchmarks
+//-----------------------------------------------------------------------------
+
+// Number of frames queued and dequeued in each sample, to overcome the
+// resolution of micros().
+const uint8_t NUM_QUEUED_FRAMES = 8;
+
+PayloadPool<FRAME_SIZE, NUM_QUEUED_DEVICES> payloadPool;
+
+/** Copy the frame into a separate buffer for each device. */
+void runMemcpyQueue() {
+  timingStats.reset();
+  for (uint16_t i = 0; i < NUM_SAMPLES; i++) {
+    uint16_t startMicros = micros();
+    for (uint8_t n = 0; n < NUM_QUEUED_FRAMES; n++) {
+      for (uint8_t j = 0; j < NUM_QUEUED_DEVICES; j++) {
+        memcpy(scratch.queue.requestBuffers[j], scratch.queue.frame,
+            FRAME_SIZE);
+      }
+    }
+    uint16_t endMicros = micros();
+    timingStats.update(endMicros - startMicros);
+    yield();
+  }
+
+  printStats(F("memcpy"), F("x4"), timingStats, NUM_SAMPLES,
+      NUM_QUEUED_FRAMES * NUM_QUEUED_DEVICES * FRAME_SIZE);
+}
+
+/**
+ * Copy the frame once into a block of the PayloadPool, add a reference for
+ * each additional device, then release the references.
+ */
+void runPayloadPoolQueue() {
+  timingStats.reset();
+  for (uint16_t i = 0; i < NUM_SAMPLES; i++) {
+    uint16_t startMicros = micros();
+    for (uint8_t n = 0; n < NUM_QUEUED_FRAMES; n++) {
+      uint8_t handle = payloadPool.acquire();
+      memcpy(payloadPool.getData(handle), scratch.queue.frame, FRAME_SIZE);
+      payloadPool.setLength(handle, FRAME_SIZE);
+      for (uint8_t j = 1; j < NUM_QUEUED_DEVICES; j++) {
+        payloadPool.retain(handle);
+      }
+      for (uint8_t j = 0; j < NUM_QUEUED_DEVICES; j++) {
+        payloadPool.release(handle);
+      }
+    }
+    uint16_t endMicros = micros();
+    timingStats.update(endMicros - startMicros);
+    yield();
+  }
+
+  printStats(F("PayloadPool"), F("x4"), timingStats, NUM_SAMPLES,
+      NUM_QUEUED_FRAMES * NUM_QUEUED_DEVICES * FRAME_SIZE);
+}
+
+//-----------------------------------------------------------------------------
+// Pixel conversion benchmarks
+//-----------------------------------------------------------------------------
+
+// 16-color palette of RGB565 colors.
+uint16_t palette[16];
+
+void setupPixelRows() {
+  for (uint8_t i = 0; i < 16; i++) {
+    palette[i] = i * 0x1111;
+  }
+  for (uint16_t i = 0; i < FRAME_WIDTH; i++) {
+    scratch.rows.paletteRow[i] = i & 0x0F;
+    scratch.rows.rgb888Row[3 * i] = i;
+    scratch.rows.rgb888Row[3 * i + 1] = i * 2;
+    scratch.rows.rgb888Row[3 * i + 2] = i * 3;
+  }
+}
+
+/**
+ * Send a full 128x160 frame, one row per transaction, converting the 8-bit
+ * palette indexes into RGB565 on the fly.
+ */
+template <typename T_SPII>
+void runConvertPalette(
+    const __FlashStringHelper* name,
+    const Rgb565Converter<T_SPII>& converter,
+    T_SPII& spiInterface) {
+  timingStats.reset();
+  for (uint16_t i = 0; i < FRAME_HEIGHT; i++) {
+    uint16_t startMicros = micros();
+    spiInterface.beginTransaction();
+    converter.writePalette(scratch.rows.paletteRow, FRAME_WIDTH, palette);
+    spiInterface.endTransaction();
+    uint16_t endMicros = micros();
+    timingStats.update(endMicros - startMicros);
+    yield();
+  }
+
+  printStats(name, F("palette(128)"), timingStats, FRAME_HEIGHT,
+      FRAME_WIDTH * 2);
+}
+
+/**
+ * Send a full 128x160 frame, one row per transaction, converting the RGB888
+ * triples into RGB565 on the fly.
+ */
+template <typename T_SPII>
+void runConvertRgb888(
+    const __FlashStringHelper* name,
+    const Rgb565Converter<T_SPII>& converter,
+    T_SPII& spiInterface) {
+  timingStats.reset();
+  for (uint16_t i = 0; i < FRAME_HEIGHT; i++) {
+    uint16_t startMicros = micros();
+    spiInterface.beginTransaction();
+    converter.writeRgb888(scratch.rows.rgb888Row, FRAME_WIDTH);
+    spiInterface.endTransaction();
+    uint16_t endMicros = micros();
+    timingStats.update(endMicros - startMicros);
+    yield();
+  }
+
+  printStats(name, F("rgb888(128)"), timingStats, FRAME_HEIGHT,
+      FRAME_WIDTH * 2);
+}
+
+void runRgb565Converter() {
+  using SpiInterface = HardSpiInterface<SPIClass>;
+  SpiInterface spiInterface(SPI, LATCH_PIN);
+  Rgb565Converter<SpiInterface> converter(spiInterface);
+
+  setupPixelRows();
+  SPI.begin();
+  spiInterface.begin();
+  runConvertPalette(F("Rgb565Converter"), converter, spiInterface);
+  runConvertRgb888(F("Rgb565Converter"), converter, spiInterface);
+  spiInterface.end();
+}
+
+//-----------------------------------------------------------------------------
+// OLED framebuffer benchmarks
+//-----------------------------------------------------------------------------
+
+// Data/command pin of the OLED display.
+const uint8_t DC_PIN = 9;
+
+// The 2 kB of RAM of the ATmega328P cannot hold a 1 kB framebuffer in addition
+// to the other buffers of this program, so emulate a 128x32 display on AVR.
+#if defined(ARDUINO_ARCH_AVR)
+const uint8_t OLED_HEIGHT = 32;
+#else
+const uint8_t OLED_HEIGHT = 64;
+#endif
+
+using OledSpiInterface = HardSpiInterface<SPIClass>;
+using OledFramebuffer = Ssd1306Framebuffer<
+    OledSpiInterface, DigitalPin<DC_PIN>, 128, OLED_HEIGHT>;
+
+/**
+ * Modify the framebuffer using the given update pattern, then flush it. The
+ * number of bytes is the number of bytes sent by each flush(), including the
+ * commands.
+ */
+void runOledUpdate(
+    const __FlashStringHelper* variant,
+    OledFramebuffer& framebuffer,
+    uint8_t pattern) {
+  uint16_t numBytes = 0;
+  timingStats.reset();
+  for (uint16_t i = 0; i < NUM_SAMPLES; i++) {
+    uint8_t bits = (i & 0x01) ? 0xFF : 0x00;
+    uint16_t startMicros = micros();
+    if (pattern == 0) {
+      // Full refresh.
+      framebuffer.markAllDirty();
+    } else if (pattern == 1) {
+      // Toggle an 8x8 icon in the top-right corner.
+      for (uint8_t x = 120; x < 128; x++) {
+        framebuffer.setColumn(0, x, bits);
+      }
+    } else {
+      // Rewrite one line of text, 8 pixels high.
+      memset(framebuffer.getBuffer() + 128, bits, 128);
+      framebuffer.markDirty(1, 0, 127);
+    }
+    numBytes = framebuffer.flush();
+    uint16_t endMicros = micros();
+    timingStats.update(endMicros - startMicros);
+    yield();
+  }
+
+  printStats(F("Ssd1306Framebuffer"), variant, timingStats, NUM_SAMPLES,
+      numBytes);
+}
+
+void runSsd1306Framebuffer() {
+  OledSpiInterface spiInterface(SPI, LATCH_PIN);
+  OledFramebuffer framebuffer(spiInterface);
+
+  SPI.begin();
+  spiInterface.begin();
+  framebuffer.begin();
+  runOledUpdate(F("full"), framebuffer, 0);
+  runOledUpdate(F("icon8x8"), framebuffer, 1);
+  runOledUpdate(F("line"), framebuffer, 2);
+  framebuffer.end();
+  spiInterface.end();
+}
+
+//-----------------------------------------------------------------------------
+// Frame delta encoding benchmarks
+//-----------------------------------------------------------------------------
+
+// Number of frames encoded in each sample, to overcome the resolution of
+// micros().
+const uint8_t NUM_ENCODED_FRAMES = 8;
+
+FrameDeltaEncoder<DELTA_FRAME_SIZE> deltaEncoder(4 /*mergeGap*/);
+FrameDeltaEncoder<DELTA_FRAME_SIZE>::Run deltaRuns[8];
+
+/**
+ * Encode the difference between 2 frames which differ in `numChanges` bytes
+ * spaced `stride` bytes apart. The number of bytes is the number of bytes of
+ * the runs of each frame, compared to DELTA_FRAME_SIZE for a full frame.
+ */
+void runFrameDelta(
+    const __FlashStringHelper* variant,
+    uint8_t numChanges,
+    uint8_t stride) {
+  memset(scratch.delta.frameA, 0, DELTA_FRAME_SIZE);
+  memset(scratch.delta.frameB, 0, DELTA_FRAME_SIZE);
+  for (uint8_t i = 0; i < numChanges; i++) {
+    scratch.delta.frameB[i * stride] = 1;
+  }
+  deltaEncoder.invalidate();
+  deltaEncoder.encode(scratch.delta.frameA, deltaRuns, 8);
+
+  uint8_t numRuns = 0;
+  timingStats.reset();
+  for (uint16_t i = 0; i < NUM_SAMPLES; i++) {
+    uint16_t startMicros = micros();
+    for (uint8_t n = 0; n < NUM_ENCODED_FRAMES; n++) {
+      const uint8_t* frame = (n & 0x01)
+          ? scratch.delta.frameA
+          : scratch.delta.frameB;
+      numRuns = deltaEncoder.encode(frame, deltaRuns, 8);
+    }
+    uint16_t endMicros = micros();
+    timingStats.update(endMicros - startMicros);
+    yield();
+  }
+
+  printStats(F("FrameDeltaEncoder"), variant, timingStats, NUM_SAMPLES,
+      deltaEncoder.countBytes(deltaRuns, numRuns));
+}
+
+void runFrameDeltaEncoder() {
+  runFrameDelta(F("encode(1)"), 1, 1);
+  runFrameDelta(F("encode(4)"), 4, 16);
+  runFrameDelta(F("encode(64)"), 64, 1);
+}
+
+//-----------------------------------------------------------------------------
+// DAC streaming benchmarks
+//-----------------------------------------------------------------------------
+
+// Number of ticks in each sample.
+const uint8_t NUM_DAC_TICKS = 16;
+
+/**
+ * Call DacStreamer::onTick() directly, without a timer, to measure the time
+ * spent in the timer interrupt for each sample of the waveform.
+ */
+void runDacStreamer() {
+  using SpiInterface = HardSpiInterface<SPIClass>;
+  SpiInterface spiInterface(SPI, LATCH_PIN);
+  DacStreamer<SpiInterface, NUM_DAC_TICKS> streamer(spiInterface, 100);
+
+  SPI.begin();
+  spiInterface.begin();
+  streamer.begin();
+  timingStats.reset();
+  for (uint16_t i = 0; i < NUM_SAMPLES; i++) {
+    for (uint8_t n = 0; n < NUM_DAC_TICKS; n++) {
+      streamer.write(streamer.mcp49xxFrame(n << 8,
+          streamer.kMcp49xxGain1x | streamer.kMcp49xxActive));
+    }
+    uint16_t startMicros = micros();
+    for (uint8_t n = 0; n < NUM_DAC_TICKS; n++) {
+      streamer.onTick();
+    }
+    uint16_t endMicros = micros();
+    timingStats.update(endMicros - startMicros);
+    yield();
+  }
+  streamer.end();
+  spiInterface.end();
+
+  printStats(F("DacStreamer"), F("onTick()x16"), timingStats, NUM_SAMPLES,
+      NUM_DAC_TICKS * 2);
 }
 
+//-----------------------------------------------------------------------------
+// APA102 LED strip benchmarks. Not on AVR, because the 256-byte correction
+// table of the Apa102Strip does not fit in the RAM of the ATmega328P, on the
+// stack or in static RAM, alongside the other buffers of this program.
+//-----------------------------------------------------------------------------
+
+#if ! defined(ARDUINO_ARCH_AVR)
+
+/**
+ * Send the start frame, the frame of each of 60 LEDs, and the end frame using
+ * one send8() per byte, applying the correction table in the same loop.
+ */
+template <typename T_SPII>
+void runApa102Send8(const Apa102Strip<T_SPII>& strip, T_SPII& spiInterface) {
+  const uint16_t numLeds = 60;
+  timingStats.reset();
+  for (uint16_t i = 0; i < NUM_SAMPLES; i++) {
+    uint16_t startMicros = micros();
+    for (uint8_t j = 0; j < 4; j++) {
+      spiInterface.send8(0x00);
+    }
+    const uint8_t* rgb = scratch.apa102Pixels;
+    for (uint16_t j = 0; j < numLeds; j++) {
+      spiInterface.send8(0xE0 | strip.getBrightness());
+      spiInterface.send8(strip.correct(rgb[2]));
+      spiInterface.send8(strip.correct(rgb[1]));
+      spiInterface.send8(strip.correct(rgb[0]));
+      rgb += 3;
+    }
+    for (uint16_t j = 0; j < 4 + (numLeds + 15) / 16; j++) {
+      spiInterface.send8(0x00);
+    }
+    uint16_t endMicros = micros();
+    timingStats.update(endMicros - startMicros);
+    yield();
+  }
+
+  printStats(F("Apa102Strip"), F("send8()x60"), timingStats, NUM_SAMPLES,
+      strip.frameSize(numLeds));
+}
+
+/** Send numLeds LEDs using a single Apa102Strip::show(). */
+template <typename T_SPII>
+void runApa102Show(
+    const __FlashStringHelper* variant,
+    const Apa102Strip<T_SPII>& strip,
+    uint16_t numLeds) {
+  timingStats.reset();
+  for (uint16_t i = 0; i < NUM_SAMPLES; i++) {
+    uint16_t startMicros = micros();
+    strip.show(scratch.apa102Pixels, numLeds);
+    uint16_t endMicros = micros();
+    timingStats.update(endMicros - startMicros);
+    yield();
+  }
+
+  printStats(F("Apa102Strip"), variant, timingStats, NUM_SAMPLES,
+      strip.frameSize(numLeds));
+}
+
+void runApa102Strip() {
+  using SpiInterface = HardSpiInterface<SPIClass>;
+  SpiInterface spiInterface(SPI, LATCH_PIN);
+  Apa102Strip<SpiInterface> strip(spiInterface);
+
+  for (uint16_t i = 0; i < APA102_MAX_LEDS * 3; i++) {
+    scratch.apa102Pixels[i] = i;
+  }
+  strip.setBrightness(16);
+  strip.setCorrection(192);
+
+  SPI.begin();
+  spiInterface.begin();
+  runApa102Send8(strip, spiInterface);
+  runApa102Show(F("show(60)"), strip, 60);
+  runApa102Show(F("show(300)"), strip, 300);
+  runApa102Show(F("show(1000)"), strip, 1000);
+  spiInterface.end();
+}
+
+//-----------------------------------------------------------------------------
+// WS2812 encoder benchmarks. Not on AVR, because the SPI clock of a 16 MHz AVR
+// cannot be 3.2 MHz, which is rejected by a static_assert in Ws2812SpiEncoder.
+//-----------------------------------------------------------------------------
+
+using Ws2812SpiInterface = HardSpiInterface<SPIClass, 3200000>;
+using Ws2812Encoder = Ws2812SpiEncoder<Ws2812SpiInterface>;
+
+// Number of LEDs of the WS2812 strip, whose pixels are in
+// scratch.apa102Pixels.
+const uint16_t WS2812_NUM_LEDS = 60;
+
+// Prevents the compiler from optimizing away the expansion.
+volatile uint32_t ws2812Checksum;
+
+/**
+ * Expand the color bytes of WS2812_NUM_LEDS pixels into their SPI symbols
+ * using `expand`, without any SPI transfer.
+ */
+void runWs2812Expand(
+    const __FlashStringHelper* variant,
+    uint32_t (*expand)(uint8_t)) {
+  timingStats.reset();
+  for (uint16_t i = 0; i < NUM_SAMPLES; i++) {
+    uint16_t startMicros = micros();
+    uint32_t checksum = 0;
+    for (uint16_t j = 0; j < WS2812_NUM_LEDS * 3; j++) {
+      checksum ^= expand(scratch.apa102Pixels[j]);
+    }
+    ws2812Checksum = checksum;
+    uint16_t endMicros = micros();
+    timingStats.update(endMicros - startMicros);
+    yield();
+  }
+
+  printStats(F("Ws2812SpiEncoder"), variant, timingStats, NUM_SAMPLES,
+      WS2812_NUM_LEDS * 3 * Ws2812Encoder::kBytesPerColor);
+}
+
+/** Send WS2812_NUM_LEDS pixels using Ws2812SpiEncoder::show(). */
+void runWs2812Show(Ws2812Encoder& encoder) {
+  timingStats.reset();
+  for (uint16_t i = 0; i < NUM_SAMPLES; i++) {
+    // Exclude the wait for the latch of the previous update.
+    delayMicroseconds(Ws2812Encoder::kResetMicros);
+    uint16_t startMicros = micros();
+    encoder.show(scratch.apa102Pixels, WS2812_NUM_LEDS);
+    uint16_t endMicros = micros();
+    timingStats.update(endMicros - startMicros);
+    yield();
+  }
+
+  printStats(F("Ws2812SpiEncoder"), F("show(60)"), timingStats, NUM_SAMPLES,
+      WS2812_NUM_LEDS * 3 * Ws2812Encoder::kBytesPerColor);
+}
+
+void runWs2812SpiEncoder() {
+  Ws2812SpiInterface spiInterface(SPI, LATCH_PIN);
+  Ws2812Encoder encoder(spiInterface);
+
+  runWs2812Expand(F("expandTable(180)"), &Ws2812Encoder::expandTable);
+  runWs2812Expand(F("expandSwar(180)"), &Ws2812Encoder::expandSwar);
+
+  SPI.begin();
+  spiInterface.begin();
+  runWs2812Show(encoder);
+  spiInterface.end();
+}
+
+#endif // ! defined(ARDUINO_ARCH_AVR)
+
+#endif // ! BENCHMARK_ATTINY
+
 //-----------------------------------------------------------------------------
 // Specific SPI implementations
 //-----------------------------------------------------------------------------
@@ -134,6 +947,17 @@ void runHardSpi() {
   spiInterface.end();
 }
 
+void runHardSpiSticky() {
+  using SpiInterface = HardSpiStickyInterface<SPIClass>;
+  SpiBusOwner busOwner;
+  SpiInterface spiInterface(SPI, busOwner, LATCH_PIN);
+
+  SPI.begin();
+  spiInterface.begin();
+  runBenchmark(F("HardSpiStickyInterface"), spiInterface);
+  spiInterface.end(); // releases the bus
+}
+
 #if defined(ARDUINO_ARCH_AVR) || defined(EPOXY_DUINO)
 void runHardSpiFast() {
   using SpiInterface = HardSpiFastInterface<SPIClass, LATCH_PIN>;
@@ -146,20 +970,192 @@ void runHardSpiFast() {
 }
 #endif
 
+#if defined(ARDUINO_ARCH_STM32)
+void runHardSpiStm32() {
+  // The default SPI instance uses SPI1 (PA5, PA6, PA7) on the STM32F103 Blue
+  // Pill. On other boards, it may be mapped to a different peripheral, which
+  // must be given here instead.
+  using SpiInterface = HardSpiStm32Interface<SPIClass, SPI_TypeDef>;
+  SpiInterface spiInterface(SPI, SPI1, LATCH_PIN);
+
+  SPI.begin();
+  spiInterface.begin();
+  runBenchmark(F("HardSpiStm32Interface"), spiInterface);
+  spiInterface.end();
+}
+#endif
+
+#if defined(ESP32)
+void runHardSpiEsp32() {
+  using SpiInterface = HardSpiEsp32Interface<SPIClass, spi_dev_t>;
+  SpiInterface spiInterface(SPI, &SPI3, LATCH_PIN);
+
+  SPI.begin();
+  spiInterface.begin();
+  runBenchmark(F("HardSpiEsp32Interface"), spiInterface);
+  spiInterface.end();
+}
+
+void runHardSpiEsp32HwCs() {
+  using SpiInterface = HardSpiEsp32Interface<
+      SPIClass, spi_dev_t, 8000000, true /*T_HARDWARE_CS*/>;
+  SpiInterface spiInterface(SPI, &SPI3, LATCH_PIN);
+
+  SPI.begin();
+  spiInterface.begin();
+  runBenchmark(F("HardSpiEsp32Interface(HwCs)"), spiInterface);
+  spiInterface.end();
+}
+#endif
+
+#if defined(__AVR_ATtiny25__) \
+    || defined(__AVR_ATtiny45__) \
+    || defined(__AVR_ATtiny85__)
+void runUsiSpi() {
+  // On the ATTinyCore, the Arduino pin number is the PORTB bit number.
+  using SpiInterface = UsiSpiInterface<LATCH_PIN, UsiRegisters>;
+  SpiInterface spiInterface;
+
+  spiInterface.begin();
+  runBenchmark(F("UsiSpiInterface"), spiInterface);
+  spiInterface.end();
+}
+#endif
+
+#if defined(ESP8266) || defined(ESP32)
+void runHardSpiHwCs() {
+  using SpiInterface = HardSpiHwCsInterface<SPIClass>;
+  SpiInterface spiInterface(SPI);
+
+  SPI.begin();
+  spiInterface.begin();
+  runBenchmark(F("HardSpiHwCsInterface"), spiInterface);
+  spiInterface.end();
+}
+#endif
+
+#if defined(STM32F1xx)
+void runSimpleSpiBitBand() {
+  // SS=PA4, MOSI=PA7, SCK=PA5 on the Blue Pill, using GPIOA_ODR.
+  using LatchPin = BitBandPin<LATCH_PIN, 0x4001080C, 4>;
+  using DataPin = BitBandPin<DATA_PIN, 0x4001080C, 7>;
+  using ClockPin = BitBandPin<CLOCK_PIN, 0x4001080C, 5>;
+  using SpiInterface = SimpleSpiBitBandInterface<LatchPin, DataPin, ClockPin>;
+  SpiInterface spiInterface;
+
+  spiInterface.begin();
+  runBenchmark(F("SimpleSpiBitBandInterface"), spiInterface);
+  spiInterface.end();
+}
+#elif defined(KINETISK)
+void runSimpleSpiBitBand() {
+  // SS=10 (PTC4), MOSI=11 (PTC6), SCK=13 (PTC5) on the Teensy 3.x, using
+  // GPIOC_PDOR.
+  using LatchPin = BitBandPin<LATCH_PIN, 0x400FF080, 4>;
+  using DataPin = BitBandPin<DATA_PIN, 0x400FF080, 6>;
+  using ClockPin = BitBandPin<CLOCK_PIN, 0x400FF080, 5>;
+  using SpiInterface = SimpleSpiBitBandInterface<LatchPin, DataPin, ClockPin>;
+  SpiInterface spiInterface;
+
+  spiInterface.begin();
+  runBenchmark(F("SimpleSpiBitBandInterface"), spiInterface);
+  spiInterface.end();
+}
+#endif
+
+#if defined(STM32F1xx)
+void runSimpleSpiWord() {
+  // SS=PA4, MOSI=PA7, SCK=PA5 on the Blue Pill, using GPIOA_ODR.
+  using LatchPin = BitBandPin<LATCH_PIN, 0x4001080C, 4>;
+  using DataPin = BitBandPin<DATA_PIN, 0x4001080C, 7>;
+  using ClockPin = BitBandPin<CLOCK_PIN, 0x4001080C, 5>;
+  using SpiInterface = SimpleSpiWordInterface<LatchPin, DataPin, ClockPin>;
+  SpiInterface spiInterface;
+
+  spiInterface.begin();
+  runBenchmark(F("SimpleSpiWordInterface"), spiInterface);
+  spiInterface.end();
+}
+#elif defined(KINETISK)
+void runSimpleSpiWord() {
+  // SS=10 (PTC4), MOSI=11 (PTC6), SCK=13 (PTC5) on the Teensy 3.x, using
+  // GPIOC_PDOR.
+  using LatchPin = BitBandPin<LATCH_PIN, 0x400FF080, 4>;
+  using DataPin = BitBandPin<DATA_PIN, 0x400FF080, 6>;
+  using ClockPin = BitBandPin<CLOCK_PIN, 0x400FF080, 5>;
+  using SpiInterface = SimpleSpiWordInterface<LatchPin, DataPin, ClockPin>;
+  SpiInterface spiInterface;
+
+  spiInterface.begin();
+  runBenchmark(F("SimpleSpiWordInterface"), spiInterface);
+  spiInterface.end();
+}
+#elif ! defined(ARDUINO_ARCH_AVR)
+void runSimpleSpiWord() {
+  // No bit-band region, so use the portable digitalWrite().
+  using SpiInterface = SimpleSpiWordInterface<
+      DigitalPin<LATCH_PIN>, DigitalPin<DATA_PIN>, DigitalPin<CLOCK_PIN>>;
+  SpiInterface spiInterface;
+
+  spiInterface.begin();
+  runBenchmark(F("SimpleSpiWordInterface"), spiInterface);
+  spiInterface.end();
+}
+#endif
+
 //-----------------------------------------------------------------------------
 // runBenchmarks()
 //-----------------------------------------------------------------------------
 
 void runBenchmarks() {
+#if ! BENCHMARK_ATTINY
   runHardSpi();
-#if defined(ARDUINO_ARCH_AVR) || defined(EPOXY_DUINO)
+  runHardSpiSticky();
+#endif
+#if (defined(ARDUINO_ARCH_AVR) || defined(EPOXY_DUINO)) && ! BENCHMARK_ATTINY
   runHardSpiFast();
 #endif
+#if defined(ARDUINO_ARCH_STM32)
+  runHardSpiStm32();
+#endif
+#if defined(ESP32)
+  runHardSpiEsp32();
+  runHardSpiEsp32HwCs();
+#endif
+#if defined(ESP8266) || defined(ESP32)
+  runHardSpiHwCs();
+#endif
+#if defined(__AVR_ATtiny25__) \
+    || defined(__AVR_ATtiny45__) \
+    || defined(__AVR_ATtiny85__)
+  runUsiSpi();
+#endif
 
   runSimpleSpi();
 #if defined(ARDUINO_ARCH_AVR) || defined(EPOXY_DUINO)
   runSimpleSpiFast();
 #endif
+#if defined(STM32F1xx) || defined(KINETISK)
+  runSimpleSpiBitBand();
+#endif
+#if ! defined(ARDUINO_ARCH_AVR)
+  runSimpleSpiWord();
+#endif
+#if ! BENCHMARK_ATTINY
+#if defined(ARDUINO_ARCH_AVR) || defined(EPOXY_DUINO)
+  runMulticast();
+#endif
+  runMemcpyQueue();
+  runPayloadPoolQueue();
+  runRgb565Converter();
+  runSsd1306Framebuffer();
+  runFrameDeltaEncoder();
+  runDacStreamer();
+#if ! defined(ARDUINO_ARCH_AVR)
+  runApa102Strip();
+  runWs2812SpiEncoder();
+#endif
+#endif
 }
 
 //-----------------------------------------------------------------------------
@@ -175,6 +1171,30 @@ void printSizeOf() {
   SERIAL_PORT_MONITOR.println(sizeof(HardSpiFastInterface<SPIClass, 11>));
 #endif
 
+#if defined(ARDUINO_ARCH_STM32)
+  SERIAL_PORT_MONITOR.print(F("sizeof(HardSpiStm32Interface): "));
+  SERIAL_PORT_MONITOR.println(
+      sizeof(HardSpiStm32Interface<SPIClass, SPI_TypeDef>));
+#endif
+
+#if defined(ESP32)
+  SERIAL_PORT_MONITOR.print(F("sizeof(HardSpiEsp32Interface): "));
+  SERIAL_PORT_MONITOR.println(
+      sizeof(HardSpiEsp32Interface<SPIClass, spi_dev_t>));
+#endif
+
+#if defined(ESP8266) || defined(ESP32)
+  SERIAL_PORT_MONITOR.print(F("sizeof(HardSpiHwCsInterface): "));
+  SERIAL_PORT_MONITOR.println(sizeof(HardSpiHwCsInterface<SPIClass>));
+#endif
+
+#if defined(__AVR_ATtiny25__) \
+    || defined(__AVR_ATtiny45__) \
+    || defined(__AVR_ATtiny85__)
+  SERIAL_PORT_MONITOR.print(F("sizeof(UsiSpiInterface): "));
+  SERIAL_PORT_MONITOR.println(sizeof(UsiSpiInterface<3, UsiRegisters>));
+#endif
+
   SERIAL_PORT_MONITOR.print(F("sizeof(SimpleSpiInterface): "));
   SERIAL_PORT_MONITOR.println(sizeof(SimpleSpiInterface));
 
@@ -182,6 +1202,20 @@ void printSizeOf() {
   SERIAL_PORT_MONITOR.print(F("sizeof(SimpleSpiFastInterface<11, 12, 13>): "));
   SERIAL_PORT_MONITOR.println(sizeof(SimpleSpiFastInterface<11, 12, 13>));
 #endif
+
+#if defined(STM32F1xx) || defined(KINETISK)
+  SERIAL_PORT_MONITOR.print(F("sizeof(SimpleSpiBitBandInterface): "));
+  SERIAL_PORT_MONITOR.println(sizeof(SimpleSpiBitBandInterface<
+      BitBandPin<10, 0x40000000, 0>,
+      BitBandPin<11, 0x40000000, 1>,
+      BitBandPin<13, 0x40000000, 2>>));
+#endif
+
+#if ! defined(ARDUINO_ARCH_AVR)
+  SERIAL_PORT_MONITOR.print(F("sizeof(SimpleSpiWordInterface): "));
+  SERIAL_PORT_MONITOR.println(sizeof(SimpleSpiWordInterface<
+      DigitalPin<10>, DigitalPin<11>, DigitalPin<13>>));
+#endif
 }
 
 //-----------------------------------------------------------------------------
@@ -90,11 +90,141 @@ implementations:
 
 * `SimpleSpiInterface`
 * `SimpleSpiFastInterface`
+* `SimpleSpiBitBandInterface` (STM32F1 and Teensy 3.x only)
+* `SimpleSpiWordInterface` (32-bit processors only)
 * `HardSpiInterface`
+* `HardSpiStickyInterface`
 * `HardSpiFastInterface`
-
-The number of bytes transferred is 8 bytes. The hardware SPI from `<SPI.h>` is
-configurd for 8 MHz during these benchmarks. The "eff kbps" is the observed
+* `HardSpiStm32Interface` (STM32 only)
+* `HardSpiEsp32Interface` (ESP32 only)
+* `HardSpiEsp32Interface(HwCs)` (ESP32 only, with `T_HARDWARE_CS=true`)
+* `HardSpiHwCsInterface` (ESP8266 and ESP32 only)
+* `UsiSpiInterface` (ATtiny25/45/85 only)
+
+Each implementation is measured with the following variants:
+
+* (no suffix): 8 bytes using 8 calls to `send8()`, each in its own transaction
+* `,send()`: the same 8 bytes in a single transaction using the variadic
+  `send(a, b, ...)` method
+* `,send16()x8`, `,send16()x16`: 8 or 16 (register, value) pairs using one
+  `send16()` per pair, emulating the refresh of a MAX7219
+* `,sendRegisters(8)`, `,sendRegisters(16)`: the same pairs using a single
+  `sendRegisters()` call, which configures the SPI settings only once
+* `,transfer16()x128`: a full 128x160 RGB565 frame, one row of 128 pixels per
+  transaction, using one `transfer16()` per pixel
+* `,transfer16Array(128)`: the same frame using one `transfer16Array()` per
+  row
+* `,buffered(64)`: a generated 64-byte pattern, first written into a buffer,
+  then sent in a single transaction using one `transfer()` per byte
+* `,sendGenerated(64)`: the same pattern sent using `sendGenerated()`, which
+  calls the generator for each byte without a buffer
+
+The pixel rows record one sample per row, so the time of the full frame is 160
+times the average.
+
+A row of 256 bytes does not fit in a 64-byte peripheral command, so the
+`HardSpiHwCsInterface` sends each row in 64-byte chunks with CS/SS driven by
+`digitalWrite()`, like the `HardSpiInterface`, and the
+`HardSpiEsp32Interface(HwCs)` holds CS/SS active across its 64-byte commands.
+
+The ATtiny25/45/85 has only 128-512 bytes of RAM and 6 I/O pins, so only the
+`UsiSpiInterface`, `SimpleSpiInterface` and `SimpleSpiFastInterface` are
+measured on it, without the pixel rows, and none of the benchmarks below.
+
+The input buffers of the benchmarks below are shared in a single union, since
+each group of benchmarks fills its own buffers before it runs. This keeps the
+static RAM of the ATmega328P to roughly 1 kB of its 2 kB, which leaves room on
+the stack for the framebuffer of the `Ssd1306Framebuffer` rows.
+
+The time of the `buffered(64)` and `sendGenerated(64)` rows includes the
+generation of the pattern. On AVR, the hardware SPI interfaces generate the next
+byte of the `sendGenerated(64)` row while the current byte is shifted out.
+
+The `SimpleSpiWordInterface` uses the same `BitBandPin` pins as the
+`SimpleSpiBitBandInterface` on the STM32F1 and Teensy 3.x, and `DigitalPin` on
+the other 32-bit processors. Its `transfer16Array(128)`, `sendRegisters()` and
+`sendGenerated(64)` rows show the saving of shifting out 32 bits per invocation
+of the bit-bang loop.
+
+The `HardSpiStickyInterface` keeps the device selected and the SPI settings
+active between transactions, so its rows show the saving compared to the
+`HardSpiInterface` rows for streams of short commands.
+
+On AVR, the multicast benchmark sends the same 8 bytes to 2, 4 or 8 devices:
+
+* `HardSpiInterface,send()xN`: one `send()` transaction per device
+* `HardSpiMulticastInterface,send()xN`: a single `send()` transaction with
+  the latch pins of all N devices asserted together
+
+The number of bytes of the multicast rows is the total number of bytes received
+by all devices (N x 8). The latch pins are 2-9. On the Nano, pins 2-7 are on the
+same port, so 2 and 4 devices are selected using a single port write, while 8
+devices fall back to `digitalWrite()`.
+
+The `memcpy,x4` and `PayloadPool,x4` rows measure only the queuing of a 32-byte
+frame to 4 devices, without any SPI transfer. The `memcpy` row copies the frame
+into a separate buffer for each device. The `PayloadPool` row copies the frame
+once into a block of a `PayloadPool`, calls `retain()` for each additional
+device, then `release()` for each device. Each sample queues 8 frames.
+
+The `Rgb565Converter,palette(128)` and `Rgb565Converter,rgb888(128)` rows send
+the same 128x160 frame as the `HardSpiInterface,transfer16Array(128)` row, but
+convert each row on the fly from 8-bit palette indexes or from RGB888 triples.
+The difference from the `transfer16Array(128)` row is the cost of the
+conversion.
+
+The `Ssd1306Framebuffer` rows modify a framebuffer of an SSD1306 OLED display,
+then flush the dirty columns using `HardSpiInterface`:
+
+* `,full`: the entire display
+* `,icon8x8`: an 8x8 icon in the top-right corner
+* `,line`: one line of text, 128 columns of one page
+
+The number of bytes is the number of bytes sent by each flush, including the
+commands. On AVR, the display is 128x32 instead of 128x64 because the 1 kB
+buffer of a 128x64 display does not fit in the RAM of the ATmega328P alongside
+the other buffers of the benchmark.
+
+The `FrameDeltaEncoder` rows measure the encoding of a 64-byte frame against
+the previous frame, with a merge gap of 4 bytes, without any SPI transfer:
+
+* `,encode(1)`: 1 changed byte
+* `,encode(4)`: 4 changed bytes, 16 bytes apart, producing 4 runs
+* `,encode(64)`: all 64 bytes changed
+
+The number of bytes is the number of bytes of the runs, which would be sent
+instead of the 64 bytes of the full frame. Each sample encodes 8 frames.
+
+The `DacStreamer,onTick()x16` row calls `DacStreamer::onTick()` 16 times
+directly, without a timer, using `HardSpiInterface`. It measures the time spent
+in the timer interrupt for each sample of a waveform sent to an MCP49xx DAC.
+
+The `Apa102Strip` rows send the pixels of an APA102 LED strip using
+`HardSpiInterface`, including the start and end frames, with a global scale
+applied through the correction table:
+
+* `,send8()x60`: 60 LEDs using one `send8()` per byte
+* `,show(60)`, `,show(300)`, `,show(1000)`: 60, 300 or 1000 LEDs using a single
+  `Apa102Strip::show()`
+
+The `Apa102Strip` rows are not measured on AVR, because the 256-byte correction
+table of the `Apa102Strip` does not fit in the RAM of the ATmega328P alongside
+the other buffers of the benchmark.
+
+The `Ws2812SpiEncoder` rows expand the 180 color bytes of 60 WS2812 LEDs into
+4-bit SPI symbols:
+
+* `,expandTable(180)`: using the nibble lookup table, without any SPI transfer
+* `,expandSwar(180)`: using shifts and masks on a 32-bit register, without any
+  SPI transfer
+* `,show(60)`: expanding and sending the 60 LEDs using
+  `HardSpiInterface<SPIClass, 3200000>`
+
+The number of bytes is the number of SPI bytes of the symbols (720). The
+`Ws2812SpiEncoder` rows are not measured on AVR, because the SPI clock of a
+16 MHz AVR cannot be 3.2 MHz.
+
+The hardware SPI from `<SPI.h>` is configurd for 8 MHz during these benchmarks. The "eff kbps" is the observed
 transfer speed in bits per second. It is usually far lower than the requested
 frequency in the `SPISettings` due to the overhead of the `beginTransaction()`,
 `endTransaction()` and the `digitalWrite()` used to latch the CS pin.
@@ -12,6 +12,9 @@ BEGIN {
 
   # Set to 1 when 'BENCHMARKS' is detected
   collect_benchmarks = 0
+
+  # Number of bytes transferred by each benchmark if not given in the file.
+  DEFAULT_TRANSFER_BYTES = 8
 }
 
 /^SIZEOF/ {
@@ -39,6 +42,8 @@ BEGIN {
     u[benchmark_index]["avg"] = $3
     u[benchmark_index]["max"] = $4
     u[benchmark_index]["samples"] = $5
+    # Older *.txt files do not contain the number of bytes.
+    u[benchmark_index]["bytes"] = ($6 == "") ? DEFAULT_TRANSFER_BYTES : $6
     benchmark_index++
   }
 }
@@ -46,7 +51,6 @@ BEGIN {
 END {
   TOTAL_BENCHMARKS = benchmark_index
   TOTAL_SIZEOF = sizeof_index
-  NUM_TRANSFER_BYTES = 8
 
   printf("Sizes of Objects:\n")
   for (i = 0; i < TOTAL_SIZEOF; i++) {
@@ -59,12 +63,17 @@ END {
   printf("+-----------------------------------------+-------------------+----------+\n")
   printf("| Functionality                           |   min/  avg/  max | eff kbps |\n")
   for (i = 0; i < TOTAL_BENCHMARKS; i++) {
+    # Print a separator whenever the interface (the part of the name before
+    # the optional comma-separated variant) changes.
     name = u[i]["name"]
-    if (name ~ /^HardSpiInterface$/) {
+    split(name, parts, ",")
+    interface = parts[1]
+    if (i == 0 || interface != prev_interface) {
       printf("|-----------------------------------------+-------------------+----------|\n")
+      prev_interface = interface
     }
 
-    speed = 1000.0 * NUM_TRANSFER_BYTES * 8 / u[i]["avg"]
+    speed = 1000.0 * u[i]["bytes"] * 8 / u[i]["avg"]
     printf("| %-39s | %5d/%5d/%5d |  %7.1f |\n",
       name, u[i]["min"], u[i]["avg"], u[i]["max"], speed)
   }
@@ -0,0 +1,398 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+/*
+ * A sketch that measures the worst-case interrupt latency observed by a
+ * periodic timer interrupt while various SPI implementations transmit
+ * payloads of different sizes. The latency is printed next to the transfer
+ * time, so that the cost of masking interrupts (e.g. SPI.usingInterrupt())
+ * can be compared against the throughput of each implementation.
+ *
+ * On AVR, Timer1 runs freely in normal mode and the ISR subtracts the scheduled
+ * compare value OCR1A from TCNT1, which gives the latency directly, even if it
+ * is longer than the period. On other platforms, the ISR records the deviation
+ * of its period from the nominal period using micros(). Under EpoxyDuino, the
+ * timer interrupt is simulated using SIGALRM from setitimer(), which is not
+ * blocked by noInterrupts(), so the native run only smoke-tests the sketch.
+ *
+ * See the README.md for more information.
+ */
+
+#include <Arduino.h>
+#include <SPI.h> // SPIClass
+#include <AceCommon.h> // TimingStats
+#include <AceSPI.h>
+
+#if defined(ARDUINO_ARCH_AVR) || defined(EPOXY_DUINO)
+#include <digitalWriteFast.h>
+#include <ace_spi/SimpleSpiFastInterface.h>
+#include <ace_spi/HardSpiFastInterface.h>
+#endif
+
+#if defined(EPOXY_DUINO)
+#include <signal.h> // signal()
+#include <sys/time.h> // setitimer()
+#endif
+
+using namespace ace_spi;
+using ace_common::TimingStats;
+
+#if ! defined(SERIAL_PORT_MONITOR)
+#define SERIAL_PORT_MONITOR Serial
+#endif
+
+// Set to 1 to call SPI.usingInterrupt(255) on AVR, which causes
+// SPIClass::beginTransaction() to disable all interrupts until
+// SPIClass::endTransaction().
+#define ENABLE_USING_INTERRUPT 0
+
+//------------------------------------------------------------------
+// Setup for SPI parameters.
+//------------------------------------------------------------------
+
+const uint8_t LATCH_PIN = SS;
+const uint8_t DATA_PIN = MOSI;
+const uint8_t CLOCK_PIN = SCK;
+
+// Period of the timer interrupt in microseconds.
+const uint16_t TIMER_PERIOD_MICROS = 100;
+
+// Payload sizes of each transaction.
+const uint8_t PAYLOAD_SIZES[] = {1, 8, 32, 128};
+const uint8_t NUM_PAYLOAD_SIZES = sizeof(PAYLOAD_SIZES);
+
+// Number of transactions for each payload size.
+const uint16_t NUM_SAMPLES = 20;
+
+//------------------------------------------------------------------
+// Timer interrupt which records the worst-case latency.
+//------------------------------------------------------------------
+
+// Maximum latency in microseconds since the last resetLatency().
+volatile uint16_t maxLatencyMicros;
+
+#if defined(ARDUINO_ARCH_AVR) && defined(TCCR1A) && defined(OCR1A)
+
+// Timer1 in normal mode, counting freely from 0 to 0xFFFF. Prescaler 8 if
+// F_CPU is at least 8 MHz, otherwise 1, so that there is at least 1 tick per
+// microsecond.
+#if F_CPU >= 8000000L
+const uint8_t TIMER_CLOCK_SELECT = _BV(CS11); // prescaler 8
+const uint8_t TICKS_PER_MICRO = F_CPU / 8 / 1000000;
+#else
+const uint8_t TIMER_CLOCK_SELECT = _BV(CS10); // prescaler 1
+const uint8_t TICKS_PER_MICRO = F_CPU / 1000000;
+#endif
+static_assert(TICKS_PER_MICRO > 0, "F_CPU must be at least 1 MHz");
+
+const uint16_t TIMER_PERIOD_TICKS = TIMER_PERIOD_MICROS * TICKS_PER_MICRO;
+
+// The ISR reads TCNT1 and subtracts the compare value OCR1A which triggered
+// it, which gives the latency in timer ticks, up to 0xFFFF ticks (32 ms at 16
+// MHz), including any periods which were missed while interrupts were
+// disabled. The next compare match is scheduled 1 period after the previous
+// one, or 1 period from now if it would already be in the past.
+ISR(TIMER1_COMPA_vect) {
+  uint16_t now = TCNT1;
+  uint16_t scheduled = OCR1A;
+  uint16_t lateTicks = now - scheduled;
+  uint16_t latency = lateTicks / TICKS_PER_MICRO;
+  if (latency > maxLatencyMicros) maxLatencyMicros = latency;
+  if (lateTicks >= TIMER_PERIOD_TICKS) {
+    OCR1A = now + TIMER_PERIOD_TICKS;
+  } else {
+    OCR1A = scheduled + TIMER_PERIOD_TICKS;
+  }
+}
+
+void setupTimer() {
+  noInterrupts();
+  TCCR1A = 0;
+  TCCR1B = TIMER_CLOCK_SELECT; // normal mode
+  TCNT1 = 0;
+  OCR1A = TIMER_PERIOD_TICKS;
+  TIFR1 = _BV(OCF1A); // clear any pending compare match
+  TIMSK1 |= _BV(OCIE1A);
+  interrupts();
+}
+
+#else
+
+// Other platforms: record how late the ISR was relative to its nominal
+// period, using micros().
+volatile uint32_t prevTickMicros;
+volatile bool isFirstTick;
+
+#if defined(ESP8266) || defined(ESP32)
+void IRAM_ATTR onTimerTick() {
+#else
+void onTimerTick() {
+#endif
+  uint32_t nowMicros = micros();
+  if (! isFirstTick) {
+    uint32_t period = nowMicros - prevTickMicros;
+    if (period > TIMER_PERIOD_MICROS) {
+      uint32_t latency = period - TIMER_PERIOD_MICROS;
+      if (latency > maxLatencyMicros) maxLatencyMicros = latency;
+    }
+  }
+  isFirstTick = false;
+  prevTickMicros = nowMicros;
+}
+
+#if defined(EPOXY_DUINO)
+
+void onSignal(int /*sig*/) {
+  onTimerTick();
+}
+
+void setupTimer() {
+  isFirstTick = true;
+  signal(SIGALRM, onSignal);
+  struct itimerval timer;
+  timer.it_interval.tv_sec = 0;
+  timer.it_interval.tv_usec = TIMER_PERIOD_MICROS;
+  timer.it_value = timer.it_interval;
+  setitimer(ITIMER_REAL, &timer, nullptr);
+}
+
+#elif defined(ESP8266)
+
+void setupTimer() {
+  isFirstTick = true;
+  timer1_attachInterrupt(onTimerTick);
+  timer1_enable(TIM_DIV16, TIM_EDGE, TIM_LOOP); // 5 ticks per micros
+  timer1_write((uint32_t) TIMER_PERIOD_MICROS * 5);
+}
+
+#elif defined(ESP32)
+
+hw_timer_t* timer;
+
+void setupTimer() {
+  isFirstTick = true;
+  timer = timerBegin(0, 80, true); // 1 tick per micros
+  timerAttachInterrupt(timer, onTimerTick, true);
+  timerAlarmWrite(timer, TIMER_PERIOD_MICROS, true);
+  timerAlarmEnable(timer);
+}
+
+#elif defined(ARDUINO_ARCH_STM32)
+
+HardwareTimer timer(TIM2);
+
+void setupTimer() {
+  isFirstTick = true;
+  timer.setOverflow(TIMER_PERIOD_MICROS, MICROSEC_FORMAT);
+  timer.attachInterrupt(onTimerTick);
+  timer.resume();
+}
+
+#elif defined(TEENSYDUINO)
+
+IntervalTimer timer;
+
+void setupTimer() {
+  isFirstTick = true;
+  timer.begin(onTimerTick, TIMER_PERIOD_MICROS);
+}
+
+#else
+  #error Unsupported platform
+
+#endif
+
+#endif
+
+void resetLatency() {
+  noInterrupts();
+  maxLatencyMicros = 0;
+  interrupts();
+}
+
+uint16_t readLatency() {
+  noInterrupts();
+  uint16_t latency = maxLatencyMicros;
+  interrupts();
+  return latency;
+}
+
+//------------------------------------------------------------------
+// Run benchmarks.
+//------------------------------------------------------------------
+
+/** Print the result for a given implementation and payload size. */
+static void printStats(
+    const __FlashStringHelper* name,
+    uint8_t numBytes,
+    const TimingStats& stats,
+    uint16_t latencyMicros,
+    uint16_t numSamples) {
+  SERIAL_PORT_MONITOR.print(name);
+  SERIAL_PORT_MONITOR.print(' ');
+  SERIAL_PORT_MONITOR.print(numBytes);
+  SERIAL_PORT_MONITOR.print(' ');
+  SERIAL_PORT_MONITOR.print(stats.getMin());
+  SERIAL_PORT_MONITOR.print(' ');
+  SERIAL_PORT_MONITOR.print(stats.getAvg());
+  SERIAL_PORT_MONITOR.print(' ');
+  SERIAL_PORT_MONITOR.print(stats.getMax());
+  SERIAL_PORT_MONITOR.print(' ');
+  SERIAL_PORT_MONITOR.print(latencyMicros);
+  SERIAL_PORT_MONITOR.print(' ');
+  SERIAL_PORT_MONITOR.println(numSamples);
+}
+
+TimingStats timingStats;
+
+/**
+ * Measure the latency when the CPU is busy-waiting without any SPI traffic,
+ * to establish the baseline latency of the timer interrupt itself.
+ */
+void runIdle() {
+  timingStats.reset();
+  resetLatency();
+  for (uint16_t i = 0; i < NUM_SAMPLES; i++) {
+    uint16_t startMicros = micros();
+    while ((uint16_t) ((uint16_t) micros() - startMicros) < 1000) {}
+    uint16_t endMicros = micros();
+    timingStats.update(endMicros - startMicros);
+    yield();
+  }
+  printStats(F("Idle"), 0, timingStats, readLatency(), NUM_SAMPLES);
+}
+
+template <typename T_SPII>
+void runBenchmark(const __FlashStringHelper* name, T_SPII& spiInterface) {
+  for (uint8_t s = 0; s < NUM_PAYLOAD_SIZES; s++) {
+    uint8_t numBytes = PAYLOAD_SIZES[s];
+    timingStats.reset();
+    resetLatency();
+    for (uint16_t i = 0; i < NUM_SAMPLES; i++) {
+      uint16_t startMicros = micros();
+      spiInterface.beginTransaction();
+      for (uint8_t b = 0; b < numBytes; b++) {
+        spiInterface.transfer(b);
+      }
+      spiInterface.endTransaction();
+      uint16_t endMicros = micros();
+      timingStats.update(endMicros - startMicros);
+      yield();
+    }
+    printStats(name, numBytes, timingStats, readLatency(), NUM_SAMPLES);
+  }
+}
+
+//-----------------------------------------------------------------------------
+// Specific SPI implementations
+//-----------------------------------------------------------------------------
+
+void runSimpleSpi() {
+  using SpiInterface = SimpleSpiInterface;
+  SpiInterface spiInterface(LATCH_PIN, DATA_PIN, CLOCK_PIN);
+
+  spiInterface.begin();
+  runBenchmark(F("SimpleSpiInterface"), spiInterface);
+  spiInterface.end();
+}
+
+#if defined(ARDUINO_ARCH_AVR) || defined(EPOXY_DUINO)
+void runSimpleSpiFast() {
+  using SpiInterface = SimpleSpiFastInterface<LATCH_PIN, DATA_PIN, CLOCK_PIN>;
+  SpiInterface spiInterface;
+
+  spiInterface.begin();
+  runBenchmark(F("SimpleSpiFastInterface"), spiInterface);
+  spiInterface.end();
+}
+#endif
+
+void runHardSpi() {
+  using SpiInterface = HardSpiInterface<SPIClass>;
+  SpiInterface spiInterface(SPI, LATCH_PIN);
+
+  SPI.begin();
+  spiInterface.begin();
+  runBenchmark(F("HardSpiInterface"), spiInterface);
+  spiInterface.end();
+}
+
+#if defined(ARDUINO_ARCH_AVR) || defined(EPOXY_DUINO)
+void runHardSpiFast() {
+  using SpiInterface = HardSpiFastInterface<SPIClass, LATCH_PIN>;
+  SpiInterface spiInterface(SPI);
+
+  SPI.begin();
+  spiInterface.begin();
+  runBenchmark(F("HardSpiFastInterface"), spiInterface);
+  spiInterface.end();
+}
+#endif
+
+//-----------------------------------------------------------------------------
+// runBenchmarks()
+//-----------------------------------------------------------------------------
+
+void runBenchmarks() {
+  runIdle();
+
+  runHardSpi();
+#if defined(ARDUINO_ARCH_AVR) || defined(EPOXY_DUINO)
+  runHardSpiFast();
+#endif
+
+  runSimpleSpi();
+#if defined(ARDUINO_ARCH_AVR) || defined(EPOXY_DUINO)
+  runSimpleSpiFast();
+#endif
+}
+
+//-----------------------------------------------------------------------------
+
+void setup() {
+#if ! defined(EPOXY_DUINO)
+  delay(1000); // Wait for stability on some boards, otherwise garage on Serial
+#endif
+
+  SERIAL_PORT_MONITOR.begin(115200);
+  while (!SERIAL_PORT_MONITOR); // Wait for Leonardo/Micro
+
+#if ENABLE_USING_INTERRUPT && defined(ARDUINO_ARCH_AVR)
+  SPI.usingInterrupt(255);
+#endif
+
+  setupTimer();
+
+  SERIAL_PORT_MONITOR.println(F("BENCHMARKS"));
+  runBenchmarks();
+
+  SERIAL_PORT_MONITOR.println(F("END"));
+
+#if defined(EPOXY_DUINO)
+  exit(0);
+#endif
+}
+
+void loop() {}
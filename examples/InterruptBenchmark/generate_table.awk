@@ -0,0 +1,57 @@
+#!/usr/bin/gawk -f
+#
+# Usage: generate_table.awk < ${board}.txt
+#
+# Takes the *.txt file generated by InterruptBenchmark.ino and generates an
+# ASCII table that shows the transfer time, the effective throughput, and the
+# worst-case interrupt latency for each SPI implementation and payload size.
+
+BEGIN {
+  # Set to 1 when 'BENCHMARKS' is detected
+  collect_benchmarks = 0
+}
+
+/^BENCHMARKS/ {
+  collect_benchmarks = 1
+  benchmark_index = 0
+  next
+}
+
+!/^END/ {
+  if (collect_benchmarks) {
+    u[benchmark_index]["name"] = $1
+    u[benchmark_index]["bytes"] = $2
+    u[benchmark_index]["min"] = $3
+    u[benchmark_index]["avg"] = $4
+    u[benchmark_index]["max"] = $5
+    u[benchmark_index]["latency"] = $6
+    u[benchmark_index]["samples"] = $7
+    benchmark_index++
+  }
+}
+
+END {
+  TOTAL_BENCHMARKS = benchmark_index
+
+  printf("+--------------------------+-------+-------------------+----------+---------+\n")
+  printf("| Functionality            | bytes |   min/  avg/  max | eff kbps | latency |\n")
+  for (i = 0; i < TOTAL_BENCHMARKS; i++) {
+    name = u[i]["name"]
+    if (name != prev_name) {
+      printf("|--------------------------+-------+-------------------+----------+---------|\n")
+      prev_name = name
+    }
+
+    if (u[i]["bytes"] == 0 || u[i]["avg"] == 0) {
+      printf("| %-24s | %5d | %5d/%5d/%5d |          |   %5d |\n",
+        name, u[i]["bytes"], u[i]["min"], u[i]["avg"], u[i]["max"],
+        u[i]["latency"])
+    } else {
+      speed = 1000.0 * u[i]["bytes"] * 8 / u[i]["avg"]
+      printf("| %-24s | %5d | %5d/%5d/%5d |  %7.1f |   %5d |\n",
+        name, u[i]["bytes"], u[i]["min"], u[i]["avg"], u[i]["max"], speed,
+        u[i]["latency"])
+    }
+  }
+  printf("+--------------------------+-------+-------------------+----------+---------+\n")
+}
@@ -20,17 +20,35 @@
 #define FEATURE_HARD_SPI_FAST 2
 #define FEATURE_SIMPLE_SPI 3
 #define FEATURE_SIMPLE_SPI_FAST 4
+#define FEATURE_HARD_SPI_SEND 5
+#define FEATURE_HARD_SPI_FAST_SEND 6
+#define FEATURE_SIMPLE_SPI_SEND 7
+#define FEATURE_SIMPLE_SPI_FAST_SEND 8
+#define FEATURE_USI_SPI 9
+#define FEATURE_SIMPLE_SPI_SOFT 10
+#define FEATURE_SIMPLE_SPI_FAST_SOFT 11
 
 // A volatile integer to prevent the compiler from optimizing away the entire
 // program.
 volatile int disableCompilerOptimization = 0;
 
 #if FEATURE > FEATURE_BASELINE
-  #include <AceSPI.h>
-  #if defined(ARDUINO_ARCH_AVR) || defined(EPOXY_DUINO)
-    #include <digitalWriteFast.h>
-    #include <ace_spi/SimpleSpiFastInterface.h>
-    #include <ace_spi/HardSpiFastInterface.h>
+  // The *_SOFT features include only the classes which do not depend on
+  // <SPI.h>, to measure the savings compared to including <AceSPI.h>.
+  #if FEATURE == FEATURE_SIMPLE_SPI_SOFT \
+      || FEATURE == FEATURE_SIMPLE_SPI_FAST_SOFT
+    #include <AceSPISoft.h>
+    #if defined(ARDUINO_ARCH_AVR) || defined(EPOXY_DUINO)
+      #include <digitalWriteFast.h>
+      #include <ace_spi/SimpleSpiFastInterface.h>
+    #endif
+  #else
+    #include <AceSPI.h>
+    #if defined(ARDUINO_ARCH_AVR) || defined(EPOXY_DUINO)
+      #include <digitalWriteFast.h>
+      #include <ace_spi/SimpleSpiFastInterface.h>
+      #include <ace_spi/HardSpiFastInterface.h>
+    #endif
   #endif
   using namespace ace_spi;
 
@@ -38,11 +56,12 @@ volatile int disableCompilerOptimization = 0;
   const uint8_t DATA_PIN = MOSI;
   const uint8_t CLOCK_PIN = SCK;
 
-  #if FEATURE == FEATURE_HARD_SPI
+  #if FEATURE == FEATURE_HARD_SPI || FEATURE == FEATURE_HARD_SPI_SEND
     using SpiInterface = HardSpiInterface<SPIClass>;
     SpiInterface spiInterface(SPI, LATCH_PIN);
 
-  #elif FEATURE == FEATURE_HARD_SPI_FAST
+  #elif FEATURE == FEATURE_HARD_SPI_FAST \
+      || FEATURE == FEATURE_HARD_SPI_FAST_SEND
     #if ! defined(ARDUINO_ARCH_AVR) && ! defined(EPOXY_DUINO)
       #error Unsupported FEATURE on this platform
     #endif
@@ -50,11 +69,15 @@ volatile int disableCompilerOptimization = 0;
     using SpiInterface = HardSpiFastInterface<SPIClass, LATCH_PIN>;
     SpiInterface spiInterface(SPI);
 
-  #elif FEATURE == FEATURE_SIMPLE_SPI
+  #elif FEATURE == FEATURE_SIMPLE_SPI \
+      || FEATURE == FEATURE_SIMPLE_SPI_SEND \
+      || FEATURE == FEATURE_SIMPLE_SPI_SOFT
     using SpiInterface = SimpleSpiInterface;
     SpiInterface spiInterface(LATCH_PIN, DATA_PIN, CLOCK_PIN);
 
-  #elif FEATURE == FEATURE_SIMPLE_SPI_FAST
+  #elif FEATURE == FEATURE_SIMPLE_SPI_FAST \
+      || FEATURE == FEATURE_SIMPLE_SPI_FAST_SEND \
+      || FEATURE == FEATURE_SIMPLE_SPI_FAST_SOFT
     #if ! defined(ARDUINO_ARCH_AVR) && ! defined(EPOXY_DUINO)
       #error Unsupported FEATURE on this platform
     #endif
@@ -62,6 +85,30 @@ volatile int disableCompilerOptimization = 0;
     using SpiInterface = SimpleSpiFastInterface<LATCH_PIN, DATA_PIN, CLOCK_PIN>;
     SpiInterface spiInterface;
 
+  #elif FEATURE == FEATURE_USI_SPI
+    #if defined(EPOXY_DUINO)
+      // Dummy registers to validate the compilation on the host machine.
+      volatile uint8_t usiRegister;
+      struct UsiRegisters {
+        static void setUsidr(uint8_t value) { usiRegister = value; }
+        static void setUsicr(uint8_t value) { usiRegister = value; }
+        static void enableOutputs() {}
+        static void disableOutputs() {}
+        static void setLatchOutput(uint8_t /*bit*/) {}
+        static void setLatchInput(uint8_t /*bit*/) {}
+        static void setLatchLow(uint8_t bit) { usiRegister = bit; }
+        static void setLatchHigh(uint8_t bit) { usiRegister = bit; }
+      };
+    #elif ! defined(__AVR_ATtiny25__) \
+        && ! defined(__AVR_ATtiny45__) \
+        && ! defined(__AVR_ATtiny85__)
+      #error Unsupported FEATURE on this platform
+    #endif
+
+    // Use PB3 as the latch pin, since PB0-PB2 are used by the USI.
+    using SpiInterface = UsiSpiInterface<3, UsiRegisters>;
+    SpiInterface spiInterface;
+
   #else
     #error Unknown FEATURE
 
@@ -92,18 +139,20 @@ void setup() {
 
   disableCompilerOptimization = 3;
 
-#if FEATURE == FEATURE_HARD_SPI
+#if FEATURE == FEATURE_HARD_SPI \
+    || FEATURE == FEATURE_HARD_SPI_FAST \
+    || FEATURE == FEATURE_HARD_SPI_SEND \
+    || FEATURE == FEATURE_HARD_SPI_FAST_SEND
   SPI.begin();
   spiInterface.begin();
 
-#elif FEATURE == FEATURE_HARD_SPI_FAST
-  SPI.begin();
-  spiInterface.begin();
-
-#elif FEATURE == FEATURE_SIMPLE_SPI
-  spiInterface.begin();
-
-#elif FEATURE == FEATURE_SIMPLE_SPI_FAST
+#elif FEATURE == FEATURE_SIMPLE_SPI \
+    || FEATURE == FEATURE_SIMPLE_SPI_FAST \
+    || FEATURE == FEATURE_SIMPLE_SPI_SEND \
+    || FEATURE == FEATURE_SIMPLE_SPI_FAST_SEND \
+    || FEATURE == FEATURE_USI_SPI \
+    || FEATURE == FEATURE_SIMPLE_SPI_SOFT \
+    || FEATURE == FEATURE_SIMPLE_SPI_FAST_SOFT
   spiInterface.begin();
 
 #else
@@ -123,13 +172,23 @@ void loop() {
 #elif FEATURE == FEATURE_SIMPLE_SPI \
     || FEATURE == FEATURE_SIMPLE_SPI_FAST \
     || FEATURE == FEATURE_HARD_SPI \
-    || FEATURE == FEATURE_HARD_SPI_FAST
+    || FEATURE == FEATURE_HARD_SPI_FAST \
+    || FEATURE == FEATURE_USI_SPI \
+    || FEATURE == FEATURE_SIMPLE_SPI_SOFT \
+    || FEATURE == FEATURE_SIMPLE_SPI_FAST_SOFT
   // Send 4 bytes, emulating a 4-digit LED module.
   spiInterface.send8(0x11);
   spiInterface.send8(0x33);
   spiInterface.send8(0x55);
   spiInterface.send8(0x77);
 
+#elif FEATURE == FEATURE_SIMPLE_SPI_SEND \
+    || FEATURE == FEATURE_SIMPLE_SPI_FAST_SEND \
+    || FEATURE == FEATURE_HARD_SPI_SEND \
+    || FEATURE == FEATURE_HARD_SPI_FAST_SEND
+  // Send the same 4 bytes in a single transaction.
+  spiInterface.send(0x11, 0x33, 0x55, 0x77);
+
 #else
   #error Unknown FEATURE
 
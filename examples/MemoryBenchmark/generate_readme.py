@@ -95,6 +95,12 @@ program for various `LedModule` configurations and various Writer classes.
 * `SimpleSpiFastInterface`
 * `HardSpiInterface`
 * `HardSpiFastInterface`
+* `UsiSpiInterface` (ATtiny25/45/85 only)
+
+The plain rows send 4 bytes using 4 calls to `send8()`. The `,send()` rows send
+the same 4 bytes in a single transaction using the variadic `send(a, b, ...)`
+method. The `(soft)` rows include `<AceSPISoft.h>` instead of `<AceSPI.h>`, so
+that the `<SPI.h>` library and its global `SPI` instance are not linked in.
 
 ### ATtiny85
 
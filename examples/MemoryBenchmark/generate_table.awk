@@ -11,6 +11,13 @@ BEGIN {
   labels[2] = "HardSpiFastInterface";
   labels[3] = "SimpleSpiInterface";
   labels[4] = "SimpleSpiFastInterface";
+  labels[5] = "HardSpiInterface,send()";
+  labels[6] = "HardSpiFastInterface,send()";
+  labels[7] = "SimpleSpiInterface,send()";
+  labels[8] = "SimpleSpiFastInterface,send()";
+  labels[9] = "UsiSpiInterface";
+  labels[10] = "SimpleSpiInterface(soft)";
+  labels[11] = "SimpleSpiFastInterface(soft)";
   record_index = 0
 }
 {
@@ -42,7 +49,9 @@ END {
   for (i = 1 ; i < NUM_ENTRIES; i++) {
     if (u[i]["flash"] == "-1") continue
 
-    if (labels[i] ~ /^HardSpiInterface/) {
+    if (labels[i] ~ /^HardSpiInterface/ \
+        || labels[i] ~ /^UsiSpiInterface/ \
+        || labels[i] == "SimpleSpiInterface(soft)") {
       printf(\
         "|---------------------------------+--------------+-------------|\n")
     }
@@ -46,13 +46,25 @@ SOFTWARE.
 #error Platforms using ArduinoCore-API not supported
 #endif
 
-// Files exported by this main header file.
+// Files exported by this main header file. The classes which do not depend on
+// <SPI.h> are collected in AceSPISoft.h.
+#include "AceSPISoft.h"
 #include "ace_spi/HardSpiInterface.h"
-#include "ace_spi/SimpleSpiInterface.h"
+#include "ace_spi/HardSpiStm32Interface.h"
+#include "ace_spi/HardSpiEsp32Interface.h"
+#include "ace_spi/HardSpiHwCsInterface.h"
+#include "ace_spi/HardSpiMulticastInterface.h"
+#include "ace_spi/SpiBusOwner.h"
+#include "ace_spi/HardSpiStickyInterface.h"
 
 // The following are commented out because they work only on AVR platforms with
 // a suitable <digitalWriteFast.h> library.
 //#include "ace_spi/HardSpiFastInterface.h"
 //#include "ace_spi/SimpleSpiFastInterface.h"
 
+// The following is commented out because it selects the implementation using
+// the digitalWriteFast macro, so it must be included explicitly, after the
+// optional <digitalWriteFast.h>.
+//#include "ace_spi/FastestHardSpi.h"
+
 #endif
@@ -0,0 +1,76 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+/**
+ * @file AceSPISoft.h
+ *
+ * Alternative main header file which exports only the classes that do not
+ * depend on `<SPI.h>`. Applications which use only software SPI should include
+ * this file instead of `AceSPI.h`, so that the `<SPI.h>` library and its
+ * global `SPI` instance are not compiled and linked into the application.
+ */
+
+#ifndef ACE_SPI_SOFT_H
+#define ACE_SPI_SOFT_H
+
+// Blacklist platforms using https://github.com/arduino/ArduinoCore-api due to
+// incompatibilities.
+#if defined(ARDUINO_API_VERSION)
+#error Platforms using ArduinoCore-API not supported
+#endif
+
+// Files exported by this header file. None of them include <SPI.h>.
+#include "ace_spi/SimpleSpiInterface.h"
+#include "ace_spi/BitBandPin.h"
+#include "ace_spi/SimpleSpiBitBandInterface.h"
+#include "ace_spi/SimpleSpiWordInterface.h"
+#include "ace_spi/UsiSpiInterface.h"
+#include "ace_spi/BufferedTransfer.h"
+#include "ace_spi/ByteArgs.h"
+#include "ace_spi/InstrumentedSpiInterface.h"
+#include "ace_spi/BusUtilizationSampler.h"
+#include "ace_spi/DeadlineMonitor.h"
+#include "ace_spi/PayloadPool.h"
+#include "ace_spi/Rgb565Converter.h"
+#include "ace_spi/DigitalPin.h"
+#include "ace_spi/TftWindowWriter.h"
+#include "ace_spi/Ssd1306Framebuffer.h"
+#include "ace_spi/TransactionCostEstimator.h"
+#include "ace_spi/FrameDeltaEncoder.h"
+#include "ace_spi/DacStreamer.h"
+#include "ace_spi/Apa102Strip.h"
+#include "ace_spi/Ws2812SpiEncoder.h"
+
+// The following are commented out because they work only on AVR platforms with
+// a suitable <digitalWriteFast.h> library.
+//#include "ace_spi/SimpleSpiFastInterface.h"
+//#include "ace_spi/DigitalFastPin.h"
+
+// The following is commented out because it selects the implementation using
+// the digitalWriteFast macro, so it must be included explicitly, after the
+// optional <digitalWriteFast.h>.
+//#include "ace_spi/FastestSoftSpi.h"
+
+#endif
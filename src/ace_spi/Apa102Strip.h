@@ -0,0 +1,170 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#ifndef ACE_SPI_APA102_STRIP_H
+#define ACE_SPI_APA102_STRIP_H
+
+#include <stdint.h>
+
+namespace ace_spi {
+
+/**
+ * Driver for a strip of APA102 or SK9822 (DotStar) LEDs on any of the
+ * XxxInterface classes. The start frame, the 4-byte frame of each LED
+ * (brightness, blue, green, red), and the end frame are streamed in a single
+ * transaction using the sendGenerated() method of the underlying interface, so
+ * neither the wire frames nor the corrected colors are stored in RAM.
+ *
+ * Each color component is passed through a 256-byte lookup table while it is
+ * streamed, instead of in a separate pass over the pixels. The table combines
+ * an optional gamma table with a global scale, and is rebuilt only by
+ * setCorrection(). The 5-bit global brightness of the APA102 is sent in the
+ * first byte of each LED frame.
+ *
+ * The end frame consists of 4 zero bytes, which latch the SK9822, followed by
+ * 1 zero byte for every 16 LEDs, which provide the extra clock edges needed to
+ * propagate the data to the end of an APA102 strip.
+ *
+ * The interface must keep CS/SS LOW for the entire transaction. A strip does
+ * not have a CS/SS input, so the latch pin of the interface can be an unused
+ * pin.
+ *
+ * @tparam T_SPII the underlying SPI interface (e.g. HardSpiInterface)
+ */
+template <typename T_SPII>
+class Apa102Strip {
+  public:
+    /** Maximum value of the 5-bit global brightness. */
+    static const uint8_t kMaxBrightness = 31;
+
+    /** Number of bytes of the start frame. */
+    static const uint8_t kStartFrameSize = 4;
+
+    /**
+     * Return the number of bytes sent by show() for `numLeds` LEDs, including
+     * the start and end frames. Must not exceed 65535 (about 16000 LEDs).
+     */
+    static uint16_t frameSize(uint16_t numLeds) {
+      return kStartFrameSize + 4 * numLeds + endFrameSize(numLeds);
+    }
+
+    /**
+     * Constructor.
+     *
+     * @param spiInterface the underlying SPI interface, stored by reference
+     */
+    explicit Apa102Strip(const T_SPII& spiInterface) :
+        mSpiInterface(spiInterface)
+    {
+      setCorrection(255);
+    }
+
+    /**
+     * Set the 5-bit global brightness (0-31) of the APA102, sent with every
+     * LED. Larger values are clamped to 31. Default is 31.
+     */
+    void setBrightness(uint8_t brightness) {
+      mBrightness = (brightness > kMaxBrightness) ? kMaxBrightness : brightness;
+    }
+
+    /** Return the 5-bit global brightness. */
+    uint8_t getBrightness() const { return mBrightness; }
+
+    /**
+     * Rebuild the lookup table applied to each color component. Each
+     * component `c` is sent as `gamma[c] * (scale + 1) / 256`, so a scale of
+     * 255 keeps the full range.
+     *
+     * @param scale global scale applied after the gamma table (0-255)
+     * @param gamma optional table of 256 entries in RAM (e.g. a gamma 2.2
+     *    curve), or nullptr for a linear response
+     */
+    void setCorrection(uint8_t scale, const uint8_t* gamma = nullptr) {
+      for (uint16_t i = 0; i < 256; i++) {
+        uint8_t value = gamma ? gamma[i] : (uint8_t) i;
+        mTable[i] = ((uint16_t) value * (scale + 1)) >> 8;
+      }
+    }
+
+    /** Return the corrected value of the color component `c`. */
+    uint8_t correct(uint8_t c) const { return mTable[c]; }
+
+    /**
+     * Send the `numLeds` pixels of `rgb`, stored as packed (red, green, blue)
+     * triples, in a single transaction.
+     */
+    void show(const uint8_t* rgb, uint16_t numLeds) const {
+      const uint8_t header = 0xE0 | mBrightness;
+      const uint8_t* table = mTable;
+      uint8_t numStartBytes = kStartFrameSize;
+      uint16_t remaining = numLeds;
+      uint8_t phase = 0;
+
+      mSpiInterface.sendGenerated(
+          [&]() -> uint8_t {
+            if (numStartBytes) {
+              numStartBytes--;
+              return 0x00;
+            }
+            if (remaining == 0) return 0x00; // end frame
+            switch (phase) {
+              case 0:
+                phase = 1;
+                return header;
+              case 1:
+                phase = 2;
+                return table[rgb[2]]; // blue
+              case 2:
+                phase = 3;
+                return table[rgb[1]]; // green
+              default:
+                phase = 0;
+                remaining--;
+                uint8_t red = table[rgb[0]];
+                rgb += 3;
+                return red;
+            }
+          },
+          frameSize(numLeds));
+    }
+
+  private:
+    // disable copy constructor and assignment operator
+    Apa102Strip(const Apa102Strip&) = delete;
+    Apa102Strip& operator=(const Apa102Strip&) = delete;
+
+    /** Number of bytes of the end frame. */
+    static uint16_t endFrameSize(uint16_t numLeds) {
+      return 4 + (numLeds + 15) / 16;
+    }
+
+    const T_SPII& mSpiInterface;
+    uint8_t mBrightness = kMaxBrightness;
+    uint8_t mTable[256];
+};
+
+} // ace_spi
+
+#endif
@@ -0,0 +1,117 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#ifndef ACE_SPI_BIT_BAND_PIN_H
+#define ACE_SPI_BIT_BAND_PIN_H
+
+#include <stdint.h>
+#include <Arduino.h> // pinMode(), OUTPUT, INPUT
+
+namespace ace_spi {
+
+/**
+ * Memory access policy for BitBandPin which dereferences the alias address
+ * directly. This is correct only on ARM Cortex-M3 and M4 processors with the
+ * bit-band feature, e.g. the STM32F1 and the Teensy 3.x. A different class
+ * which maps the alias address into an array can be substituted on a host
+ * machine.
+ */
+struct BitBandMemory {
+  /** Return the pointer to the 32-bit word at the given address. */
+  static volatile uint32_t* word(uint32_t address) {
+    return (volatile uint32_t*) (uintptr_t) address;
+  }
+};
+
+/**
+ * Pin policy which writes a single bit of a GPIO output register through its
+ * bit-band alias on ARM Cortex-M3 and M4 processors. Each write is a single
+ * 32-bit store, without a mask or a read-modify-write. The alias address is
+ * computed at compile-time from the address of the output register and the
+ * bit number:
+ *
+ *    alias = 0x42000000 + (T_REG_ADDR - 0x40000000) * 32 + T_BIT * 4
+ *
+ * For example, pin PA5 of the STM32F103 is `BitBandPin<PA5, 0x4001080C, 5>`
+ * using GPIOA_ODR, and pin 13 (PTC5) of the Teensy 3.2 is
+ * `BitBandPin<13, 0x400FF080, 5>` using GPIOC_PDOR.
+ *
+ * @tparam T_PIN the Arduino pin number, used only by pinMode()
+ * @tparam T_REG_ADDR address of the GPIO output data register, which must be
+ *    in the peripheral bit-band region (0x40000000 - 0x400FFFFF)
+ * @tparam T_BIT bit number (0-31) of the pin in the output register
+ * @tparam T_MEMORY memory access policy, default BitBandMemory
+ */
+template <
+    uint8_t T_PIN,
+    uint32_t T_REG_ADDR,
+    uint8_t T_BIT,
+    typename T_MEMORY = BitBandMemory
+>
+class BitBandPin {
+  public:
+    /** Start of the peripheral bit-band region. */
+    static constexpr uint32_t kRegionBase = 0x40000000;
+
+    /** Start of the peripheral bit-band alias region. */
+    static constexpr uint32_t kAliasBase = 0x42000000;
+
+    /** Bit-band alias address of the pin. */
+    static constexpr uint32_t kAliasAddress =
+        kAliasBase + ((T_REG_ADDR - kRegionBase) << 5) + (T_BIT << 2);
+
+    static_assert(T_REG_ADDR >= kRegionBase && T_REG_ADDR < 0x40100000,
+        "T_REG_ADDR must be in the peripheral bit-band region");
+    static_assert(T_BIT < 32, "T_BIT must be less than 32");
+
+    /** Configure the pin as an OUTPUT. */
+    static void setOutput() { pinMode(T_PIN, OUTPUT); }
+
+    /** Configure the pin as an INPUT. */
+    static void setInput() { pinMode(T_PIN, INPUT); }
+
+    /** Set the pin HIGH. */
+    static void setHigh() { *T_MEMORY::word(kAliasAddress) = 1; }
+
+    /** Set the pin LOW. */
+    static void setLow() { *T_MEMORY::word(kAliasAddress) = 0; }
+
+    /** Write the lowest bit of `bit`, without a branch. */
+    static void write(uint8_t bit) { *T_MEMORY::word(kAliasAddress) = bit; }
+};
+
+// Definitions of the static constants, required in C++11 if they are odr-used.
+template <uint8_t T_PIN, uint32_t T_REG_ADDR, uint8_t T_BIT, typename T_MEMORY>
+constexpr uint32_t BitBandPin<T_PIN, T_REG_ADDR, T_BIT, T_MEMORY>::kRegionBase;
+
+template <uint8_t T_PIN, uint32_t T_REG_ADDR, uint8_t T_BIT, typename T_MEMORY>
+constexpr uint32_t BitBandPin<T_PIN, T_REG_ADDR, T_BIT, T_MEMORY>::kAliasBase;
+
+template <uint8_t T_PIN, uint32_t T_REG_ADDR, uint8_t T_BIT, typename T_MEMORY>
+constexpr uint32_t BitBandPin<T_PIN, T_REG_ADDR, T_BIT, T_MEMORY>::kAliasAddress;
+
+} // ace_spi
+
+#endif
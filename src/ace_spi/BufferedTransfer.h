@@ -0,0 +1,60 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#ifndef ACE_SPI_BUFFERED_TRANSFER_H
+#define ACE_SPI_BUFFERED_TRANSFER_H
+
+namespace ace_spi {
+
+/**
+ * Compile-time test of whether the transfer() method of the interface class
+ * `T_SPII` may return before the byte has been shifted out, because the bytes
+ * are buffered (HardSpiEsp32Interface, HardSpiHwCsInterface) or pipelined
+ * through the transmit buffer of the peripheral (HardSpiStm32Interface).
+ * Those classes declare a `static const bool kBufferedTransfer = true`, and
+ * `isBufferedTransfer<T_SPII>::value` is false for every other class.
+ *
+ * Helper classes which toggle a pin between 2 transfers of the same
+ * transaction (e.g. the D/C pin of TftWindowWriter) use this to reject those
+ * interfaces at compile-time.
+ */
+template <typename T_SPII>
+struct isBufferedTransfer {
+  private:
+    template <typename T>
+    static constexpr bool get(decltype(T::kBufferedTransfer)*) {
+      return T::kBufferedTransfer;
+    }
+
+    template <typename T>
+    static constexpr bool get(...) { return false; }
+
+  public:
+    static const bool value = get<T_SPII>(nullptr);
+};
+
+} // ace_spi
+
+#endif
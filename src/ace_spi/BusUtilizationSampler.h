@@ -0,0 +1,200 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#ifndef ACE_SPI_BUS_UTILIZATION_SAMPLER_H
+#define ACE_SPI_BUS_UTILIZATION_SAMPLER_H
+
+#include <stdint.h>
+#include <Arduino.h> // micros()
+
+namespace ace_spi {
+
+/**
+ * A monitor for InstrumentedSpiInterface which accumulates the time spent
+ * between beginTransaction() and endTransaction(), the number of bytes
+ * transferred, and the number of transactions. A single instance should be
+ * shared by all interfaces on the same SPI bus, so that the statistics
+ * describe the bus as a whole.
+ *
+ * The counters are collected into buckets of (approximately) `bucketMicros`
+ * duration. The most recent `T_NUM_BUCKETS` completed buckets form a sliding
+ * window over which the utilization percentage, bytes per second, and
+ * transactions per second are reported. The `update()` method must be called
+ * periodically (e.g. from the global `loop()`) to close the current bucket
+ * when its duration has elapsed. The actual elapsed duration of each bucket is
+ * recorded, so calling `update()` late does not distort the rates.
+ *
+ * The hooks called on each transaction perform only a call to `micros()` and
+ * a few additions. The divisions are deferred to the query methods.
+ *
+ * This class is not interrupt-safe. All interfaces sharing this object, and
+ * the calls to update(), must run in the same thread of execution.
+ *
+ * @tparam T_NUM_BUCKETS number of completed buckets in the sliding window,
+ *    default 4
+ */
+template <uint8_t T_NUM_BUCKETS = 4>
+class BusUtilizationSampler {
+  public:
+    /**
+     * Constructor.
+     *
+     * @param bucketMicros duration of each bucket in microseconds, default
+     *    250000 (0.25 s), so that the default sliding window is 1 second
+     */
+    explicit BusUtilizationSampler(uint32_t bucketMicros = 250000) :
+        mBucketMicros(bucketMicros)
+    {}
+
+    /** Clear all buckets and start a new bucket at the current time. */
+    void reset() {
+      mBucketStartMicros = micros();
+      mBusyMicros = 0;
+      mNumBytes = 0;
+      mNumTransactions = 0;
+      mBucketIndex = 0;
+      mNumBuckets = 0;
+    }
+
+    /**
+     * Close the current bucket if `bucketMicros` has elapsed. Should be called
+     * frequently, e.g. from the global `loop()`.
+     */
+    void update() {
+      uint32_t nowMicros = micros();
+      uint32_t elapsedMicros = nowMicros - mBucketStartMicros;
+      if (elapsedMicros < mBucketMicros) return;
+
+      Bucket& bucket = mBuckets[mBucketIndex];
+      bucket.elapsedMicros = elapsedMicros;
+      bucket.busyMicros = mBusyMicros;
+      bucket.numBytes = mNumBytes;
+      bucket.numTransactions = mNumTransactions;
+
+      mBucketIndex++;
+      if (mBucketIndex >= T_NUM_BUCKETS) mBucketIndex = 0;
+      if (mNumBuckets < T_NUM_BUCKETS) mNumBuckets++;
+
+      mBucketStartMicros = nowMicros;
+      mBusyMicros = 0;
+      mNumBytes = 0;
+      mNumTransactions = 0;
+    }
+
+    /** Percentage of time (0-100) that the bus was busy over the window. */
+    uint8_t getUtilizationPercent() const {
+      uint32_t elapsedMicros = sumElapsedMicros();
+      if (elapsedMicros == 0) return 0;
+      uint32_t busyMicros = 0;
+      for (uint8_t i = 0; i < mNumBuckets; i++) {
+        busyMicros += mBuckets[i].busyMicros;
+      }
+      // A transaction straddling a bucket boundary is credited entirely to
+      // the later bucket, so clamp to 100%.
+      uint32_t percent = (uint64_t) busyMicros * 100 / elapsedMicros;
+      return (percent > 100) ? 100 : percent;
+    }
+
+    /** Number of bytes transferred per second over the window. */
+    uint32_t getBytesPerSecond() const {
+      uint32_t elapsedMicros = sumElapsedMicros();
+      if (elapsedMicros == 0) return 0;
+      uint32_t numBytes = 0;
+      for (uint8_t i = 0; i < mNumBuckets; i++) {
+        numBytes += mBuckets[i].numBytes;
+      }
+      return (uint64_t) numBytes * 1000000 / elapsedMicros;
+    }
+
+    /** Number of transactions per second over the window. */
+    uint32_t getTransactionsPerSecond() const {
+      uint32_t elapsedMicros = sumElapsedMicros();
+      if (elapsedMicros == 0) return 0;
+      uint32_t numTransactions = 0;
+      for (uint8_t i = 0; i < mNumBuckets; i++) {
+        numTransactions += mBuckets[i].numTransactions;
+      }
+      return (uint64_t) numTransactions * 1000000 / elapsedMicros;
+    }
+
+    /**
+     * Actual duration of the sliding window in microseconds. This will be
+     * less than `T_NUM_BUCKETS * bucketMicros` until enough buckets have been
+     * filled after reset().
+     */
+    uint32_t getWindowMicros() const {
+      return sumElapsedMicros();
+    }
+
+    /** Called by InstrumentedSpiInterface::beginTransaction(). */
+    void onBeginTransaction() {
+      mTransactionStartMicros = micros();
+    }
+
+    /** Called by InstrumentedSpiInterface::transfer() and transfer16(). */
+    void onTransfer(uint32_t numBytes) {
+      mNumBytes += numBytes;
+    }
+
+    /** Called by InstrumentedSpiInterface::endTransaction(). */
+    void onEndTransaction() {
+      mBusyMicros += micros() - mTransactionStartMicros;
+      mNumTransactions++;
+    }
+
+  private:
+    /** Counters of a completed bucket. */
+    struct Bucket {
+      uint32_t elapsedMicros;
+      uint32_t busyMicros;
+      uint32_t numBytes;
+      uint32_t numTransactions;
+    };
+
+    uint32_t sumElapsedMicros() const {
+      uint32_t elapsedMicros = 0;
+      for (uint8_t i = 0; i < mNumBuckets; i++) {
+        elapsedMicros += mBuckets[i].elapsedMicros;
+      }
+      return elapsedMicros;
+    }
+
+    Bucket mBuckets[T_NUM_BUCKETS];
+    uint32_t const mBucketMicros;
+
+    // Counters of the current bucket.
+    uint32_t mBucketStartMicros = 0;
+    uint32_t mTransactionStartMicros = 0;
+    uint32_t mBusyMicros = 0;
+    uint32_t mNumBytes = 0;
+    uint32_t mNumTransactions = 0;
+
+    uint8_t mBucketIndex = 0;
+    uint8_t mNumBuckets = 0;
+};
+
+} // ace_spi
+
+#endif
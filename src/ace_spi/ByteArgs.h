@@ -0,0 +1,64 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#ifndef ACE_SPI_BYTE_ARGS_H
+#define ACE_SPI_BYTE_ARGS_H
+
+namespace ace_spi {
+
+/**
+ * Compile-time test of whether every type in `T_ARGS` can be passed as a byte
+ * to the variadic `send(value, values...)` method of the interface classes,
+ * which converts each argument to `uint8_t`. A type is accepted if it is 1
+ * byte wide, or if it is `int`, which is the type of an integer literal such
+ * as `0x02`. Wider types (e.g. `uint16_t` on 32-bit processors, `long`,
+ * `uint32_t`) are rejected, so that a 16-bit or 32-bit value is not silently
+ * truncated to its lowest byte. Such a value must be cast explicitly, or sent
+ * using transfer16().
+ *
+ * (The `<type_traits>` header is not available on AVR, so this uses only
+ * sizeof() and template specialization.)
+ */
+template <typename... T_ARGS>
+struct areByteArgs;
+
+template <>
+struct areByteArgs<> {
+  static const bool value = true;
+};
+
+template <typename T, typename... T_ARGS>
+struct areByteArgs<T, T_ARGS...> {
+  static const bool value = sizeof(T) == 1 && areByteArgs<T_ARGS...>::value;
+};
+
+template <typename... T_ARGS>
+struct areByteArgs<int, T_ARGS...> {
+  static const bool value = areByteArgs<T_ARGS...>::value;
+};
+
+} // ace_spi
+
+#endif
@@ -0,0 +1,276 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#ifndef ACE_SPI_DAC_STREAMER_H
+#define ACE_SPI_DAC_STREAMER_H
+
+#include <stdint.h>
+#include <Arduino.h> // micros()
+#include "DigitalPin.h" // NullPin
+
+namespace ace_spi {
+
+/**
+ * Streams 16-bit frames to an SPI DAC (e.g. MCP4921/4922 or other MCP49xx
+ * devices) at a fixed sample rate. The application writes the frames into a
+ * ring buffer from the main thread, and a timer interrupt calls onTick() once
+ * per sample period, which sends the next frame using send16() of the
+ * underlying interface.
+ *
+ * If the DAC has an LDAC pin, it can be controlled by `T_LDAC_PIN`. Each tick
+ * then first pulses LDAC, which updates the output with the frame sent on the
+ * previous tick, before it sends the next frame. The output is updated at the
+ * start of the tick, independent of the time taken by the SPI transfer, at
+ * the cost of 1 sample of latency. With the default NullPin, the DAC must be
+ * configured to update its output when CS/SS goes HIGH.
+ *
+ * If the buffer is empty on a tick, nothing is sent, the DAC holds its last
+ * output, and the underrun counter is incremented. Each tick also records the
+ * interval since the previous tick, to measure the jitter of the timer.
+ *
+ * The ring buffer is safe for a single producer in the main thread and a
+ * single consumer in onTick(). The 16-bit and 32-bit statistics are updated by
+ * onTick(), so on 8-bit processors they should be read with interrupts
+ * disabled. If other devices on the same SPI bus are used from the main
+ * thread, the main thread must disable the timer interrupt during its
+ * transactions (e.g. using `SPI.usingInterrupt()`).
+ *
+ * Since onTick() runs in an interrupt, the send16() of T_SPII must be safe to
+ * call from an ISR. This is the case for the HardSpiInterface and
+ * HardSpiFastInterface on AVR and STM32, and for the software interfaces
+ * (SimpleSpiInterface and its variants). It is not the case on the ESP32,
+ * where the `SPIClass::beginTransaction()` called by HardSpiInterface takes a
+ * FreeRTOS mutex, nor for the HardSpiHwCsInterface and HardSpiEsp32Interface.
+ * On the ESP32, call onTick() from a high priority task woken by the timer
+ * instead of from the ISR, pinned to the same core as the task which calls
+ * write().
+ *
+ * @tparam T_SPII the underlying SPI interface (e.g. HardSpiFastInterface)
+ * @tparam T_BUFFER_SIZE number of frames in the ring buffer, a power of 2
+ *    (2-128)
+ * @tparam T_LDAC_PIN pin policy of the LDAC pin (e.g. DigitalFastPin), or
+ *    NullPin if LDAC is not used
+ */
+template <
+    typename T_SPII,
+    uint8_t T_BUFFER_SIZE = 32,
+    typename T_LDAC_PIN = NullPin
+>
+class DacStreamer {
+  static_assert(T_BUFFER_SIZE >= 2 && T_BUFFER_SIZE <= 128
+      && (T_BUFFER_SIZE & (T_BUFFER_SIZE - 1)) == 0,
+      "T_BUFFER_SIZE must be a power of 2 between 2 and 128");
+
+  public:
+    /** MCP49xx configuration: channel B (0 for channel A). */
+    static const uint16_t kMcp49xxChannelB = 0x8000;
+
+    /** MCP49xx configuration: buffered VREF input. */
+    static const uint16_t kMcp49xxBuffered = 0x4000;
+
+    /** MCP49xx configuration: 1x gain (0 for 2x gain). */
+    static const uint16_t kMcp49xxGain1x = 0x2000;
+
+    /** MCP49xx configuration: output active (0 for shutdown). */
+    static const uint16_t kMcp49xxActive = 0x1000;
+
+    /**
+     * Return the MCP49xx frame for the 12-bit `value` (use the upper 8 or 10
+     * bits for the 8-bit and 10-bit devices) with the given configuration
+     * bits, e.g. `kMcp49xxGain1x | kMcp49xxActive`.
+     */
+    static uint16_t mcp49xxFrame(uint16_t value, uint16_t config) {
+      return config | (value & 0x0FFF);
+    }
+
+    /**
+     * Constructor.
+     *
+     * @param spiInterface the underlying SPI interface, stored by reference
+     * @param periodMicros the nominal sample period, used to calculate the
+     *    jitter
+     */
+    explicit DacStreamer(const T_SPII& spiInterface, uint32_t periodMicros) :
+        mSpiInterface(spiInterface),
+        mPeriodMicros(periodMicros)
+    {}
+
+    /** Configure the LDAC pin. Does not initialize the SPI interface. */
+    void begin() {
+      T_LDAC_PIN::setOutput();
+      T_LDAC_PIN::setHigh();
+      clear();
+      resetStats();
+    }
+
+    /** Release the LDAC pin. */
+    void end() {
+      T_LDAC_PIN::setInput();
+    }
+
+    /** Discard all frames in the buffer. Call only when the timer is stopped. */
+    void clear() {
+      mHead = 0;
+      mTail = 0;
+    }
+
+    /**
+     * Append a frame to the buffer. Return false if the buffer is full. Call
+     * from the main thread only.
+     */
+    bool write(uint16_t frame) {
+      uint8_t head = mHead;
+      if ((uint8_t) (head - mTail) >= T_BUFFER_SIZE) return false;
+      mBuffer[head & kMask] = frame;
+      // The mBuffer is not volatile, so prevent the compiler from sinking its
+      // store below the store into mHead, which publishes the frame.
+      compilerBarrier();
+      mHead = head + 1;
+      return true;
+    }
+
+    /** Number of frames in the buffer. */
+    uint8_t available() const {
+      return (uint8_t) (mHead - mTail);
+    }
+
+    /** Number of frames that can be written without blocking. */
+    uint8_t getFreeCount() const {
+      return T_BUFFER_SIZE - available();
+    }
+
+    /**
+     * Send the next frame. Call from the timer interrupt once per sample
+     * period.
+     */
+    void onTick() {
+      onTick(micros());
+    }
+
+    /**
+     * Send the next frame, using `nowMicros` as the time of the tick. This
+     * overload allows a simulated timer to drive the streamer.
+     */
+    void onTick(uint32_t nowMicros) {
+      // Update the output with the frame sent on the previous tick.
+      T_LDAC_PIN::setLow();
+      T_LDAC_PIN::setHigh();
+
+      updateStats(nowMicros);
+
+      uint8_t tail = mTail;
+      if (tail == mHead) {
+        mUnderrunCount++;
+        return;
+      }
+      // Read the frame only after mHead, and release its slot only after it
+      // was read.
+      compilerBarrier();
+      uint16_t frame = mBuffer[tail & kMask];
+      compilerBarrier();
+      mTail = tail + 1;
+      mSpiInterface.send16(frame);
+    }
+
+    /** Reset the tick, underrun and period statistics. */
+    void resetStats() {
+      mTickCount = 0;
+      mUnderrunCount = 0;
+      mMinPeriodMicros = UINT32_MAX;
+      mMaxPeriodMicros = 0;
+    }
+
+    /** Number of ticks since resetStats(). */
+    uint32_t getTickCount() const { return mTickCount; }
+
+    /** Number of ticks which found the buffer empty. */
+    uint16_t getUnderrunCount() const { return mUnderrunCount; }
+
+    /** Shortest interval between 2 ticks, UINT32_MAX if none. */
+    uint32_t getMinPeriodMicros() const { return mMinPeriodMicros; }
+
+    /** Longest interval between 2 ticks, 0 if none. */
+    uint32_t getMaxPeriodMicros() const { return mMaxPeriodMicros; }
+
+    /**
+     * Largest deviation of the interval between 2 ticks from the nominal
+     * period, 0 if fewer than 2 ticks were recorded.
+     */
+    uint32_t getMaxJitterMicros() const {
+      if (mTickCount < 2) return 0;
+      uint32_t early = (mMinPeriodMicros < mPeriodMicros)
+          ? mPeriodMicros - mMinPeriodMicros : 0;
+      uint32_t late = (mMaxPeriodMicros > mPeriodMicros)
+          ? mMaxPeriodMicros - mPeriodMicros : 0;
+      return (early > late) ? early : late;
+    }
+
+  private:
+    // disable copy constructor and assignment operator
+    DacStreamer(const DacStreamer&) = delete;
+    DacStreamer& operator=(const DacStreamer&) = delete;
+
+    static const uint8_t kMask = T_BUFFER_SIZE - 1;
+
+    /**
+     * Prevent the compiler from moving memory accesses across this point.
+     * The producer and the consumer run on the same core, so no hardware
+     * memory barrier is needed.
+     */
+    static void compilerBarrier() {
+      __asm__ __volatile__ ("" ::: "memory");
+    }
+
+    void updateStats(uint32_t nowMicros) {
+      if (mTickCount > 0) {
+        uint32_t period = nowMicros - mLastTickMicros;
+        if (period < mMinPeriodMicros) mMinPeriodMicros = period;
+        if (period > mMaxPeriodMicros) mMaxPeriodMicros = period;
+      }
+      mLastTickMicros = nowMicros;
+      mTickCount++;
+    }
+
+    const T_SPII& mSpiInterface;
+    uint32_t const mPeriodMicros;
+
+    uint16_t mBuffer[T_BUFFER_SIZE];
+
+    /** Free-running write counter, incremented by write(). */
+    volatile uint8_t mHead = 0;
+
+    /** Free-running read counter, incremented by onTick(). */
+    volatile uint8_t mTail = 0;
+
+    volatile uint32_t mTickCount = 0;
+    volatile uint32_t mLastTickMicros = 0;
+    volatile uint32_t mMinPeriodMicros = UINT32_MAX;
+    volatile uint32_t mMaxPeriodMicros = 0;
+    volatile uint16_t mUnderrunCount = 0;
+};
+
+} // ace_spi
+
+#endif
@@ -0,0 +1,247 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#ifndef ACE_SPI_DEADLINE_MONITOR_H
+#define ACE_SPI_DEADLINE_MONITOR_H
+
+#include <stdint.h>
+#include <Arduino.h> // micros(), noInterrupts(), SREG, cli()
+
+namespace ace_spi {
+
+/**
+ * A monitor for InstrumentedSpiInterface which detects transactions that
+ * exceed a latency budget. Two budgets are supported:
+ *
+ *  * transaction budget: the time spent inside beginTransaction() to
+ *    endTransaction(), inclusive of the bus setup and latch toggling,
+ *  * queue budget: the time between a call to markReady(), which signals that
+ *    the data is ready to be sent, and the subsequent beginTransaction().
+ *
+ * A budget of 0 disables the corresponding check. On each overrun, the
+ * overrun flag is set, the overrun counter is incremented, the type,
+ * duration, and timestamp of the overrun are recorded, and the optional
+ * OverrunHandler is called. The handler is called from within
+ * beginTransaction() or endTransaction(), so it should return quickly.
+ *
+ * Each interface with its own latency budget should have its own
+ * DeadlineMonitor instance.
+ */
+class DeadlineMonitor {
+  public:
+    /** The transaction took longer than the transaction budget. */
+    static const uint8_t kOverrunTransaction = 0;
+
+    /** The transaction started later than the queue budget. */
+    static const uint8_t kOverrunQueue = 1;
+
+    /**
+     * Signature of the overrun handler.
+     *
+     * @param monitor the DeadlineMonitor which detected the overrun
+     * @param overrunType kOverrunTransaction or kOverrunQueue
+     * @param elapsedMicros the duration which exceeded the budget
+     */
+    typedef void (*OverrunHandler)(
+        DeadlineMonitor* monitor,
+        uint8_t overrunType,
+        uint32_t elapsedMicros);
+
+    /**
+     * Constructor.
+     *
+     * @param transactionBudgetMicros maximum duration of a transaction, 0 to
+     *    disable the check
+     * @param queueBudgetMicros maximum delay from markReady() to
+     *    beginTransaction(), 0 to disable the check (default)
+     * @param handler optional handler called on each overrun (default nullptr)
+     */
+    explicit DeadlineMonitor(
+        uint32_t transactionBudgetMicros,
+        uint32_t queueBudgetMicros = 0,
+        OverrunHandler handler = nullptr
+    ) :
+        mTransactionBudgetMicros(transactionBudgetMicros),
+        mQueueBudgetMicros(queueBudgetMicros),
+        mHandler(handler)
+    {}
+
+    /** Set the transaction budget. 0 disables the check. */
+    void setTransactionBudget(uint32_t budgetMicros) {
+      mTransactionBudgetMicros = budgetMicros;
+    }
+
+    /** Set the queue budget. 0 disables the check. */
+    void setQueueBudget(uint32_t budgetMicros) {
+      mQueueBudgetMicros = budgetMicros;
+    }
+
+    /** Set the overrun handler. Use nullptr to remove it. */
+    void setOverrunHandler(OverrunHandler handler) { mHandler = handler; }
+
+    /**
+     * Mark the time at which the next transaction became ready to be sent.
+     * The delay until the following beginTransaction() is checked against the
+     * queue budget. Can be called from an ISR if the queue budget is used to
+     * measure the latency from a timer tick to the SPI transaction.
+     */
+    void markReady() {
+      mReadyMicros = micros();
+      mReady = true;
+    }
+
+    /** Return true if an overrun occurred since the last clearOverrun(). */
+    bool isOverrun() const { return mOverrun; }
+
+    /** Clear the overrun flag. The counters are not affected. */
+    void clearOverrun() { mOverrun = false; }
+
+    /** Clear the overrun flag and all counters. */
+    void reset() {
+      mOverrun = false;
+      mReady = false;
+      mNumTransactions = 0;
+      mNumOverruns = 0;
+      mMaxTransactionMicros = 0;
+      mMaxQueueMicros = 0;
+      mLastOverrunType = kOverrunTransaction;
+      mLastOverrunMicros = 0;
+      mLastOverrunTimestamp = 0;
+    }
+
+    /** Total number of transactions observed. */
+    uint32_t getNumTransactions() const { return mNumTransactions; }
+
+    /** Total number of overruns of either type. */
+    uint32_t getNumOverruns() const { return mNumOverruns; }
+
+    /** Longest transaction duration observed. */
+    uint32_t getMaxTransactionMicros() const { return mMaxTransactionMicros; }
+
+    /** Longest queueing delay observed. */
+    uint32_t getMaxQueueMicros() const { return mMaxQueueMicros; }
+
+    /** Type of the most recent overrun. */
+    uint8_t getLastOverrunType() const { return mLastOverrunType; }
+
+    /** Duration of the most recent overrun. */
+    uint32_t getLastOverrunMicros() const { return mLastOverrunMicros; }
+
+    /** The micros() timestamp when the most recent overrun was detected. */
+    uint32_t getLastOverrunTimestamp() const { return mLastOverrunTimestamp; }
+
+    /** Called by InstrumentedSpiInterface::beginTransaction(). */
+    void onBeginTransaction() {
+      mStartMicros = micros();
+      uint32_t readyMicros;
+      if (takeReady(readyMicros)) {
+        uint32_t queueMicros = mStartMicros - readyMicros;
+        if (queueMicros > mMaxQueueMicros) mMaxQueueMicros = queueMicros;
+        if (mQueueBudgetMicros && queueMicros > mQueueBudgetMicros) {
+          recordOverrun(kOverrunQueue, queueMicros, mStartMicros);
+        }
+      }
+    }
+
+    /** Called by InstrumentedSpiInterface::transfer() and transfer16(). */
+    void onTransfer(uint32_t /*numBytes*/) {}
+
+    /** Called by InstrumentedSpiInterface::endTransaction(). */
+    void onEndTransaction() {
+      uint32_t nowMicros = micros();
+      uint32_t elapsedMicros = nowMicros - mStartMicros;
+      mNumTransactions++;
+      if (elapsedMicros > mMaxTransactionMicros) {
+        mMaxTransactionMicros = elapsedMicros;
+      }
+      if (mTransactionBudgetMicros
+          && elapsedMicros > mTransactionBudgetMicros) {
+        recordOverrun(kOverrunTransaction, elapsedMicros, nowMicros);
+      }
+    }
+
+  private:
+    // Disable copy-constructor and assignment operator
+    DeadlineMonitor(const DeadlineMonitor&) = delete;
+    DeadlineMonitor& operator=(const DeadlineMonitor&) = delete;
+
+    /**
+     * If markReady() was called, copy its timestamp into `readyMicros`, clear
+     * the ready flag, and return true. The flag and the timestamp written by
+     * markReady() in an ISR are read and cleared with interrupts disabled on
+     * all platforms. Otherwise, the 32-bit read could be torn on AVR, and a
+     * markReady() between the read and the clear of the flag would be lost on
+     * every platform. On AVR, the previous interrupt state is restored, so
+     * this can also be called with interrupts disabled.
+     */
+    bool takeReady(uint32_t& readyMicros) {
+    #if defined(ARDUINO_ARCH_AVR)
+      uint8_t oldSREG = SREG;
+      cli();
+    #else
+      noInterrupts();
+    #endif
+      bool ready = mReady;
+      readyMicros = mReadyMicros;
+      mReady = false;
+    #if defined(ARDUINO_ARCH_AVR)
+      SREG = oldSREG;
+    #else
+      interrupts();
+    #endif
+      return ready;
+    }
+
+    void recordOverrun(
+        uint8_t overrunType, uint32_t elapsedMicros, uint32_t nowMicros) {
+      mOverrun = true;
+      mNumOverruns++;
+      mLastOverrunType = overrunType;
+      mLastOverrunMicros = elapsedMicros;
+      mLastOverrunTimestamp = nowMicros;
+      if (mHandler) mHandler(this, overrunType, elapsedMicros);
+    }
+
+    uint32_t mTransactionBudgetMicros;
+    uint32_t mQueueBudgetMicros;
+    OverrunHandler mHandler;
+
+    uint32_t mStartMicros = 0;
+    volatile uint32_t mReadyMicros = 0;
+    volatile bool mReady = false;
+    bool mOverrun = false;
+    uint8_t mLastOverrunType = kOverrunTransaction;
+
+    uint32_t mNumTransactions = 0;
+    uint32_t mNumOverruns = 0;
+    uint32_t mMaxTransactionMicros = 0;
+    uint32_t mMaxQueueMicros = 0;
+    uint32_t mLastOverrunMicros = 0;
+    uint32_t mLastOverrunTimestamp = 0;
+};
+
+} // ace_spi
+
+#endif
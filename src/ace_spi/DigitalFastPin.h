@@ -0,0 +1,69 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#ifndef ACE_SPI_DIGITAL_FAST_PIN_H
+#define ACE_SPI_DIGITAL_FAST_PIN_H
+
+#include <stdint.h>
+#include <Arduino.h> // OUTPUT, INPUT
+
+namespace ace_spi {
+
+/**
+ * Pin policy which controls a pin using pinModeFast() and digitalWriteFast()
+ * from one of the digitalWriteFast libraries on AVR processors. Each write
+ * compiles into a single `sbi` or `cbi` instruction because the pin number is
+ * a compile-time constant.
+ *
+ * @tparam T_PIN the Arduino pin number
+ */
+template <uint8_t T_PIN>
+class DigitalFastPin {
+  public:
+    /** Configure the pin as an OUTPUT. */
+    static void setOutput() { pinModeFast(T_PIN, OUTPUT); }
+
+    /** Configure the pin as an INPUT. */
+    static void setInput() { pinModeFast(T_PIN, INPUT); }
+
+    /** Set the pin HIGH. */
+    static void setHigh() { digitalWriteFast(T_PIN, HIGH); }
+
+    /** Set the pin LOW. */
+    static void setLow() { digitalWriteFast(T_PIN, LOW); }
+
+    /** Write the lowest bit of `bit`. */
+    static void write(uint8_t bit) {
+      if (bit & 0x01) {
+        digitalWriteFast(T_PIN, HIGH);
+      } else {
+        digitalWriteFast(T_PIN, LOW);
+      }
+    }
+};
+
+} // ace_spi
+
+#endif
@@ -0,0 +1,76 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#ifndef ACE_SPI_DIGITAL_PIN_H
+#define ACE_SPI_DIGITAL_PIN_H
+
+#include <stdint.h>
+#include <Arduino.h> // pinMode(), digitalWrite(), OUTPUT, INPUT
+
+namespace ace_spi {
+
+/**
+ * Pin policy which controls a pin using the portable pinMode() and
+ * digitalWrite() functions. It has the same static methods as BitBandPin and
+ * DigitalFastPin, so that a faster policy can be substituted on platforms
+ * that support one.
+ *
+ * @tparam T_PIN the Arduino pin number
+ */
+template <uint8_t T_PIN>
+class DigitalPin {
+  public:
+    /** Configure the pin as an OUTPUT. */
+    static void setOutput() { pinMode(T_PIN, OUTPUT); }
+
+    /** Configure the pin as an INPUT. */
+    static void setInput() { pinMode(T_PIN, INPUT); }
+
+    /** Set the pin HIGH. */
+    static void setHigh() { digitalWrite(T_PIN, HIGH); }
+
+    /** Set the pin LOW. */
+    static void setLow() { digitalWrite(T_PIN, LOW); }
+
+    /** Write the lowest bit of `bit`. */
+    static void write(uint8_t bit) { digitalWrite(T_PIN, bit & 0x01); }
+};
+
+/**
+ * Pin policy for an optional pin which is not connected. All methods do
+ * nothing, and are optimized away by the compiler.
+ */
+class NullPin {
+  public:
+    static void setOutput() {}
+    static void setInput() {}
+    static void setHigh() {}
+    static void setLow() {}
+    static void write(uint8_t /*bit*/) {}
+};
+
+} // ace_spi
+
+#endif
@@ -0,0 +1,110 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#ifndef ACE_SPI_FASTEST_HARD_SPI_H
+#define ACE_SPI_FASTEST_HARD_SPI_H
+
+#include <stdint.h>
+#include <Arduino.h>
+
+#if defined(__AVR_ATtiny25__) \
+    || defined(__AVR_ATtiny45__) \
+    || defined(__AVR_ATtiny85__)
+  #define ACE_SPI_FASTEST_HARD_SPI_USI 1
+  #include "UsiSpiInterface.h"
+#elif defined(ARDUINO_ARCH_AVR) && defined(digitalWriteFast)
+  #define ACE_SPI_FASTEST_HARD_SPI_FAST 1
+  #include <SPI.h>
+  #include "HardSpiFastInterface.h"
+#else
+  #include <SPI.h>
+  #include "HardSpiInterface.h"
+#endif
+
+namespace ace_spi {
+
+/**
+ * Resolves to the fastest hardware SPI interface available on the target
+ * platform, using the default `SPI` instance, with the same default
+ * constructor on all platforms:
+ *
+ *  * ATtiny25/45/85: UsiSpiInterface (`SPI.begin()` is not required)
+ *  * AVR, if a `<digitalWriteFast.h>` library was included before this
+ *    header: HardSpiFastInterface
+ *  * all others, including STM32 and ESP32: HardSpiInterface
+ *
+ * This header is not included by `<AceSPI.h>`, because the AVR selection
+ * depends on the `digitalWriteFast` macro at the point of inclusion. It must
+ * be included explicitly, after `<digitalWriteFast.h>`, and with the same
+ * includes before it in every file which uses it. Otherwise, the class would
+ * resolve to different implementations in different translation units.
+ *
+ * The HardSpiStm32Interface and HardSpiEsp32Interface are not selected. The
+ * peripheral behind the default `SPI` instance depends on the pins of the
+ * board variant (it is not always SPI1 on the STM32), some families (e.g.
+ * STM32H7) do not have the DR register, and both classes hold the SPI bus from
+ * begin() to end(), which deadlocks a second device on the same bus on the
+ * ESP32. Use those classes directly when the register block and the bus
+ * ownership are known.
+ *
+ * @tparam T_LATCH_PIN the latch pin (CS)
+ * @tparam T_CLOCK_SPEED the SPI clock speed, default 8000000 (8 MHz), ignored
+ *    by the UsiSpiInterface
+ */
+template <uint8_t T_LATCH_PIN, uint32_t T_CLOCK_SPEED = 8000000>
+class FastestHardSpi :
+  #if defined(ACE_SPI_FASTEST_HARD_SPI_USI)
+    public UsiSpiInterface<T_LATCH_PIN, UsiRegisters>
+  #elif defined(ACE_SPI_FASTEST_HARD_SPI_FAST)
+    public HardSpiFastInterface<SPIClass, T_LATCH_PIN, T_CLOCK_SPEED>
+  #else
+    public HardSpiInterface<SPIClass, T_CLOCK_SPEED>
+  #endif
+{
+  public:
+    /** The selected implementation. */
+  #if defined(ACE_SPI_FASTEST_HARD_SPI_USI)
+    using Base = UsiSpiInterface<T_LATCH_PIN, UsiRegisters>;
+  #elif defined(ACE_SPI_FASTEST_HARD_SPI_FAST)
+    using Base = HardSpiFastInterface<SPIClass, T_LATCH_PIN, T_CLOCK_SPEED>;
+  #else
+    using Base = HardSpiInterface<SPIClass, T_CLOCK_SPEED>;
+  #endif
+
+    /** Constructor. */
+    explicit FastestHardSpi() :
+  #if defined(ACE_SPI_FASTEST_HARD_SPI_USI)
+        Base()
+  #elif defined(ACE_SPI_FASTEST_HARD_SPI_FAST)
+        Base(SPI)
+  #else
+        Base(SPI, T_LATCH_PIN)
+  #endif
+    {}
+};
+
+} // ace_spi
+
+#endif
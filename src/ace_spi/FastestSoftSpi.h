@@ -0,0 +1,104 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#ifndef ACE_SPI_FASTEST_SOFT_SPI_H
+#define ACE_SPI_FASTEST_SOFT_SPI_H
+
+#include <stdint.h>
+
+#if defined(ARDUINO_ARCH_AVR) && defined(digitalWriteFast)
+  #define ACE_SPI_FASTEST_SOFT_SPI_FAST 1
+  #include "SimpleSpiFastInterface.h"
+#elif ! defined(ARDUINO_ARCH_AVR) && ! defined(ARDUINO_ARCH_MEGAAVR)
+  #define ACE_SPI_FASTEST_SOFT_SPI_WORD 1
+  #include "DigitalPin.h"
+  #include "SimpleSpiWordInterface.h"
+#else
+  #include "SimpleSpiInterface.h"
+#endif
+
+namespace ace_spi {
+
+/**
+ * Resolves to the fastest software SPI interface available on the target
+ * platform, with the same default constructor on all platforms:
+ *
+ *  * AVR, if a `<digitalWriteFast.h>` library was included before this
+ *    header: SimpleSpiFastInterface
+ *  * other AVR and megaAVR: SimpleSpiInterface
+ *  * all others (32-bit processors): SimpleSpiWordInterface using DigitalPin
+ *
+ * The SimpleSpiBitBandInterface, and the SimpleSpiWordInterface with
+ * BitBandPin, are not selected because the address of the GPIO output
+ * register of each pin cannot be derived from the pin number at compile-time.
+ *
+ * Like FastestHardSpi, this header is not included by `<AceSPISoft.h>`, and
+ * must be included explicitly, after `<digitalWriteFast.h>`, with the same
+ * includes before it in every file which uses it.
+ *
+ * @tparam T_LATCH_PIN the latch pin (CS)
+ * @tparam T_DATA_PIN the data pin (MOSI)
+ * @tparam T_CLOCK_PIN the clock pin (CLK)
+ */
+template <uint8_t T_LATCH_PIN, uint8_t T_DATA_PIN, uint8_t T_CLOCK_PIN>
+class FastestSoftSpi :
+  #if defined(ACE_SPI_FASTEST_SOFT_SPI_FAST)
+    public SimpleSpiFastInterface<T_LATCH_PIN, T_DATA_PIN, T_CLOCK_PIN>
+  #elif defined(ACE_SPI_FASTEST_SOFT_SPI_WORD)
+    public SimpleSpiWordInterface<
+        DigitalPin<T_LATCH_PIN>,
+        DigitalPin<T_DATA_PIN>,
+        DigitalPin<T_CLOCK_PIN>>
+  #else
+    public SimpleSpiInterface
+  #endif
+{
+  public:
+    /** The selected implementation. */
+  #if defined(ACE_SPI_FASTEST_SOFT_SPI_FAST)
+    using Base = SimpleSpiFastInterface<T_LATCH_PIN, T_DATA_PIN, T_CLOCK_PIN>;
+  #elif defined(ACE_SPI_FASTEST_SOFT_SPI_WORD)
+    using Base = SimpleSpiWordInterface<
+        DigitalPin<T_LATCH_PIN>,
+        DigitalPin<T_DATA_PIN>,
+        DigitalPin<T_CLOCK_PIN>>;
+  #else
+    using Base = SimpleSpiInterface;
+  #endif
+
+    /** Constructor. */
+    explicit FastestSoftSpi() :
+  #if defined(ACE_SPI_FASTEST_SOFT_SPI_FAST) \
+      || defined(ACE_SPI_FASTEST_SOFT_SPI_WORD)
+        Base()
+  #else
+        Base(T_LATCH_PIN, T_DATA_PIN, T_CLOCK_PIN)
+  #endif
+    {}
+};
+
+} // ace_spi
+
+#endif
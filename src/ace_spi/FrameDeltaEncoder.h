@@ -0,0 +1,145 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#ifndef ACE_SPI_FRAME_DELTA_ENCODER_H
+#define ACE_SPI_FRAME_DELTA_ENCODER_H
+
+#include <stdint.h>
+#include <string.h> // memcpy()
+
+namespace ace_spi {
+
+/**
+ * Compares each new frame with the last transmitted frame, and produces the
+ * list of (offset, length) runs of changed bytes, for devices which accept
+ * writes at an arbitrary offset (e.g. LED drivers, RAM-backed display
+ * controllers). The caller sends each run in its own transaction, prefixed
+ * by whatever address header the device requires.
+ *
+ * Two runs separated by a gap of at most `mergeGap` unchanged bytes are
+ * merged into a single run, because resending the gap is cheaper than the
+ * overhead of another transaction. The merge gap should be the overhead of a
+ * transaction in units of bytes (see TransactionCostEstimator), plus the size
+ * of the address header of each run.
+ *
+ * The encoder holds a copy of the last frame, so it uses T_FRAME_SIZE bytes of
+ * RAM.
+ *
+ * @tparam T_FRAME_SIZE size of the frame in bytes
+ */
+template <uint16_t T_FRAME_SIZE>
+class FrameDeltaEncoder {
+  static_assert(T_FRAME_SIZE > 0, "T_FRAME_SIZE must be > 0");
+
+  public:
+    /** A run of changed bytes. */
+    struct Run {
+      uint16_t offset;
+      uint16_t length;
+    };
+
+    /**
+     * Constructor. The first call to encode() returns the entire frame as a
+     * single run.
+     *
+     * @param mergeGap largest gap of unchanged bytes between 2 runs which is
+     *    merged into a single run
+     */
+    explicit FrameDeltaEncoder(uint16_t mergeGap = 0) :
+        mMergeGap(mergeGap)
+    {}
+
+    /** Set the largest gap of unchanged bytes which is merged. */
+    void setMergeGap(uint16_t mergeGap) { mMergeGap = mergeGap; }
+
+    /** Return the merge gap. */
+    uint16_t getMergeGap() const { return mMergeGap; }
+
+    /**
+     * Forget the last frame, so that the next encode() returns the entire
+     * frame, e.g. after the device was reset.
+     */
+    void invalidate() { mValid = false; }
+
+    /**
+     * Compare `frame` with the last frame, write the runs of changed bytes
+     * into `runs` in increasing order of offset, and return the number of
+     * runs. If there are more than `maxRuns` runs, the remaining changes are
+     * merged into the last run, so the runs always cover every changed byte.
+     * The frame then becomes the last frame, so the caller must send all the
+     * runs.
+     */
+    uint8_t encode(const uint8_t* frame, Run* runs, uint8_t maxRuns) {
+      if (maxRuns == 0) return 0;
+      if (! mValid) {
+        memcpy(mLastFrame, frame, T_FRAME_SIZE);
+        mValid = true;
+        runs[0].offset = 0;
+        runs[0].length = T_FRAME_SIZE;
+        return 1;
+      }
+
+      uint8_t numRuns = 0;
+      uint16_t runEnd = 0; // one past the last changed byte of the last run
+      for (uint16_t i = 0; i < T_FRAME_SIZE; i++) {
+        if (frame[i] == mLastFrame[i]) continue;
+        mLastFrame[i] = frame[i];
+
+        if (numRuns == 0
+            || (i - runEnd > mMergeGap && numRuns < maxRuns)) {
+          runs[numRuns].offset = i;
+          numRuns++;
+        }
+        runEnd = i + 1;
+        runs[numRuns - 1].length = runEnd - runs[numRuns - 1].offset;
+      }
+      return numRuns;
+    }
+
+    /** Return the total number of bytes of the given runs. */
+    static uint16_t countBytes(const Run* runs, uint8_t numRuns) {
+      uint16_t numBytes = 0;
+      for (uint8_t i = 0; i < numRuns; i++) {
+        numBytes += runs[i].length;
+      }
+      return numBytes;
+    }
+
+    /** Return the last frame, i.e. the current contents of the device. */
+    const uint8_t* getLastFrame() const { return mLastFrame; }
+
+  private:
+    // disable copy constructor and assignment operator
+    FrameDeltaEncoder(const FrameDeltaEncoder&) = delete;
+    FrameDeltaEncoder& operator=(const FrameDeltaEncoder&) = delete;
+
+    uint8_t mLastFrame[T_FRAME_SIZE];
+    uint16_t mMergeGap;
+    bool mValid = false;
+};
+
+} // ace_spi
+
+#endif
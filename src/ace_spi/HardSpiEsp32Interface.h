@@ -0,0 +1,357 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#ifndef ACE_SPI_HARD_SPI_ESP32_INTERFACE_H
+#define ACE_SPI_HARD_SPI_ESP32_INTERFACE_H
+
+#include <stdint.h>
+#include <Arduino.h> // digitalWrite()
+#include <SPI.h>
+#include "ByteArgs.h"
+
+namespace ace_spi {
+
+/**
+ * Hardware SPI interface for the ESP32 which bypasses the `SPIClass` for each
+ * transaction. The ESP32 `SPIClass::beginTransaction()` takes a mutex and
+ * reprograms the clock and mode registers of the peripheral on every call,
+ * which makes HardSpiInterface slower than the bit-banging SimpleSpiInterface.
+ *
+ * This class calls `SPIClass::beginTransaction()` only once in begin() to let
+ * the core configure the clock and SPI mode, and keeps the transaction (and
+ * the mutex) open until end(). Each transfer() then writes the byte directly
+ * into the 64-byte `data_buf` of the peripheral. The buffered bytes are shifted
+ * out as a single peripheral command when the buffer overflows, or when
+ * endTransaction() is called.
+ *
+ * If `T_HARDWARE_CS` is true, the latch pin is not toggled in software.
+ * Instead, `SPIClass::setHwCs(true)` is called in begin(), and the peripheral
+ * asserts its CS/SS pin (the `ss` pin given to `SPIClass::begin()`) for the
+ * duration of each command. A transaction longer than 64 bytes is sent as
+ * multiple commands, so the `pin.cs_keep_active` bit of the peripheral is set
+ * before the first one, and cleared after the last one, to hold CS/SS LOW
+ * between them. (`SPIClass::setHwCs()` cannot be used for that, because it
+ * takes the bus mutex held by this object.)
+ *
+ * Since the transaction is held open, this class owns the SPI bus between
+ * begin() and end(). Other devices must not use the same `SPIClass` object
+ * during that time.
+ *
+ * The object holds the bytes of the current 32-bit word, so it cannot be
+ * copied. It must be stored by reference by the objects which use it. Since
+ * transfer() returns before the byte is shifted out, it cannot be used with
+ * helper classes which toggle a pin within a transaction (TftWindowWriter,
+ * Ssd1306Framebuffer).
+ *
+ * The register block is a template parameter, normally `spi_dev_t` from
+ * `<soc/spi_struct.h>` (e.g. `SPI3` for the default VSPI bus, `SPI2` for
+ * HSPI). The `cmd.usr`, `mosi_dlen.usr_mosi_dbitlen`,
+ * `miso_dlen.usr_miso_dbitlen`, `pin.cs_keep_active` and `data_buf[16]`
+ * fields are used. Only the
+ * original ESP32 is supported, because the ESP32-S2/S3/C3 use a different
+ * register layout. Any struct with those fields can be used, which allows the
+ * register sequence to be verified on a host machine.
+ *
+ * @tparam T_SPI the class of the hardware SPI instance, usually SPIClass
+ * @tparam T_REGS the class of the SPI register block, usually spi_dev_t
+ * @tparam T_CLOCK_SPEED the SPI clock speed, default 8000000 (8 MHz)
+ * @tparam T_HARDWARE_CS let the peripheral control the CS/SS pin, default
+ *    false
+ */
+template <
+    typename T_SPI,
+    typename T_REGS,
+    uint32_t T_CLOCK_SPEED = 8000000,
+    bool T_HARDWARE_CS = false
+>
+class HardSpiEsp32Interface {
+  private:
+    /** MSB first or LSB first */
+    static const uint8_t kBitOrder = MSBFIRST;
+
+    /** SPI mode */
+    static const uint8_t kSpiMode = SPI_MODE0;
+
+    /** Size of the data_buf[] of the peripheral in bytes. */
+    static const uint8_t kBufferSize = 64;
+
+  public:
+    /**
+     * The bytes are sent when the buffer is full or in endTransaction(), so
+     * transfer() returns before they are shifted out. See isBufferedTransfer.
+     */
+    static const bool kBufferedTransfer = true;
+
+    /**
+     * Constructor.
+     *
+     * @param spi instance of the `T_SPI` class, used only in begin() and end()
+     *    to configure the peripheral
+     * @param regs pointer to the register block of the same SPI peripheral
+     *    (e.g. `&SPI3` for the default `SPI` object)
+     * @param latchPin the pin that controls the CS/SS pin of the slave
+     *    device, ignored if `T_HARDWARE_CS` is true
+     */
+    explicit HardSpiEsp32Interface(T_SPI& spi, T_REGS* regs, uint8_t latchPin) :
+        mSpi(spi),
+        mRegs(regs),
+        mLatchPin(latchPin)
+    {}
+
+    /**
+     * Initialize the HardSpiEsp32Interface. The hardware SPI object must be
+     * initialized using `SPI.begin()` before calling this. This configures the
+     * SPI peripheral using the `SPIClass` and keeps the transaction open.
+     */
+    void begin() const {
+      if (T_HARDWARE_CS) {
+        mSpi.setHwCs(true);
+      } else {
+        pinMode(mLatchPin, OUTPUT);
+      }
+      mSpi.beginTransaction(SPISettings(T_CLOCK_SPEED, kBitOrder, kSpiMode));
+      mCount = 0;
+      mWord = 0;
+    }
+
+    /** Clean up the object. Releases the SPIClass transaction. */
+    void end() const {
+      mSpi.endTransaction();
+      if (T_HARDWARE_CS) {
+        mSpi.setHwCs(false);
+      } else {
+        pinMode(mLatchPin, INPUT);
+      }
+    }
+
+    /** Begin SPI transaction. Pull latch LOW, unless T_HARDWARE_CS. */
+    void beginTransaction() const {
+      if (! T_HARDWARE_CS) digitalWrite(mLatchPin, LOW);
+    }
+
+    /**
+     * End SPI transaction. Send any buffered bytes, then pull latch HIGH,
+     * unless T_HARDWARE_CS.
+     */
+    void endTransaction() const {
+      flush();
+      if (! T_HARDWARE_CS) digitalWrite(mLatchPin, HIGH);
+    }
+
+    /**
+     * Transfer 8 bits. The byte is written into the data buffer of the
+     * peripheral, and sent when the buffer overflows or the transaction ends.
+     */
+    void transfer(uint8_t value) const {
+      // Send a full buffer only when the next byte arrives, so that a
+      // transaction of exactly 64 bytes is still a single command.
+      if (mCount == kBufferSize) spill();
+
+      // The peripheral sends the bytes of each 32-bit word of data_buf[] in
+      // little-endian order.
+      mWord |= ((uint32_t) value) << ((mCount & 0x03) * 8);
+      mCount++;
+      if ((mCount & 0x03) == 0) {
+        mRegs->data_buf[(mCount - 1) >> 2] = mWord;
+        mWord = 0;
+      }
+    }
+
+    /** Transfer 16 bits. */
+    void transfer16(uint16_t value) const {
+      transfer((uint8_t) (value >> 8));
+      transfer((uint8_t) value);
+    }
+
+    /**
+     * Transfer an array of 16-bit values (e.g. RGB565 pixels), each in
+     * big-endian wire order (MSB first).
+     */
+    void transfer16Array(const uint16_t* values, uint16_t count) const {
+      for (uint16_t i = 0; i < count; i++) {
+        transfer16(values[i]);
+      }
+    }
+
+    /** Convenience method to send 8 bits a single transaction. */
+    void send8(uint8_t value) const {
+      beginTransaction();
+      transfer(value);
+      endTransaction();
+    }
+
+    /** Convenience method to send 16 bits a single transaction. */
+    void send16(uint16_t value) const {
+      beginTransaction();
+      transfer16(value);
+      endTransaction();
+    }
+
+    /** Convenience method to send 16 bits a single transaction. */
+    void send16(uint8_t msb, uint8_t lsb) const {
+      beginTransaction();
+      transfer(msb);
+      transfer(lsb);
+      endTransaction();
+    }
+
+    /**
+     * Convenience method to send a fixed sequence of bytes in a single
+     * transaction, e.g. `send(opcode, arg1, arg2)`. The arguments are expanded
+     * at compile-time into a straight sequence of transfer() calls, without
+     * copying them into a temporary array.
+     */
+    template <typename... T_ARGS>
+    void send(uint8_t value, T_ARGS... values) const {
+      static_assert(areByteArgs<T_ARGS...>::value,
+          "send() sends 1 byte per argument; cast wider values to uint8_t");
+      beginTransaction();
+      transferEach(value, values...);
+      endTransaction();
+    }
+
+    /**
+     * Send an array of (register, value) pairs, e.g. to initialize or refresh
+     * a MAX7219. The latch is pulsed after every `pairsPerLatch` pairs, which
+     * is the minimum allowed by devices that latch a 16-bit register write on
+     * the rising edge of CS/SS. The peripheral is already configured, so there
+     * is no per-pair settings overhead.
+     *
+     * @param pairs array of `2 * numPairs` bytes: {reg0, value0, reg1,
+     *    value1, ...}
+     * @param numPairs number of (register, value) pairs
+     * @param pairsPerLatch number of pairs shifted out between latch pulses,
+     *    default 1
+     */
+    void sendRegisters(
+        const uint8_t* pairs,
+        uint8_t numPairs,
+        uint8_t pairsPerLatch = 1
+    ) const {
+      if (pairsPerLatch == 0) pairsPerLatch = 1;
+      for (uint8_t i = 0; i < numPairs; ) {
+        beginTransaction();
+        for (uint8_t j = 0; j < pairsPerLatch && i < numPairs; j++, i++) {
+          transfer(pairs[0]);
+          transfer(pairs[1]);
+          pairs += 2;
+        }
+        endTransaction();
+      }
+    }
+
+    /**
+     * Send `count` bytes returned by successive calls to `generator()` in a
+     * single transaction, without an intermediate array. The generator is any
+     * function object (e.g. a lambda) whose `operator()` returns the next
+     * byte, and is usually inlined by the compiler.
+     *
+     * The bytes are collected into the data buffer of the peripheral, which is
+     * sent each time it fills up.
+     */
+    template <typename T_GENERATOR>
+    void sendGenerated(T_GENERATOR&& generator, uint16_t count) const {
+      beginTransaction();
+      for (uint16_t i = 0; i < count; i++) {
+        transfer(generator());
+      }
+      endTransaction();
+    }
+
+  private:
+    // disable copy constructor and assignment operator
+    HardSpiEsp32Interface(const HardSpiEsp32Interface&) = delete;
+    HardSpiEsp32Interface& operator=(const HardSpiEsp32Interface&) = delete;
+
+    /** Terminate the recursion of transferEach(). */
+    void transferEach() const {}
+
+    /** Transfer each argument in order. */
+    template <typename... T_ARGS>
+    void transferEach(uint8_t value, T_ARGS... values) const {
+      transfer(value);
+      transferEach(values...);
+    }
+
+    /**
+     * Send the full buffer in the middle of a transaction. If the peripheral
+     * controls CS/SS, keep it active until flush() sends the last chunk.
+     */
+    void spill() const {
+      if (T_HARDWARE_CS && ! mKeepCs) {
+        mRegs->pin.cs_keep_active = 1;
+        mKeepCs = true;
+      }
+      sendCommand();
+    }
+
+    /**
+     * Send the remaining bytes at the end of the transaction, then release
+     * CS/SS if it was kept active by spill().
+     */
+    void flush() const {
+      sendCommand();
+      if (T_HARDWARE_CS && mKeepCs) {
+        mRegs->pin.cs_keep_active = 0;
+        mKeepCs = false;
+      }
+    }
+
+    /**
+     * Write the partial word (if any) into the data buffer, then shift out
+     * all buffered bytes with a single user command, and wait for it to
+     * complete.
+     */
+    void sendCommand() const {
+      if (mCount == 0) return;
+      if (mCount & 0x03) {
+        mRegs->data_buf[mCount >> 2] = mWord;
+        mWord = 0;
+      }
+      uint16_t numBits = (uint16_t) mCount * 8 - 1;
+      mRegs->mosi_dlen.usr_mosi_dbitlen = numBits;
+      mRegs->miso_dlen.usr_miso_dbitlen = numBits;
+      mRegs->cmd.usr = 1;
+      while (mRegs->cmd.usr) {}
+      mCount = 0;
+    }
+
+    T_SPI& mSpi;
+    T_REGS* mRegs;
+    uint8_t mLatchPin;
+
+    /** Bytes of the current 32-bit word not yet written into data_buf[]. */
+    mutable uint32_t mWord = 0;
+
+    /** Number of bytes buffered in the current command. */
+    mutable uint8_t mCount = 0;
+
+    /** Set while `pin.cs_keep_active` holds CS/SS across commands. */
+    mutable bool mKeepCs = false;
+};
+
+} // ace_spi
+
+#endif
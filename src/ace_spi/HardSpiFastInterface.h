@@ -28,6 +28,7 @@ SOFTWARE.
 #include <stdint.h>
 #include <Arduino.h>
 #include <SPI.h>
+#include "ByteArgs.h"
 
 namespace ace_spi {
 
@@ -67,6 +68,9 @@ class HardSpiFastInterface {
     /** SPI mode */
     static const uint8_t kSpiMode = SPI_MODE0;
 
+    /** Size of the stack buffer used by transfer16Array(). */
+    static const uint8_t kBurstSize = 32;
+
   public:
     /**
      * Constructor.
@@ -123,6 +127,31 @@ class HardSpiFastInterface {
       mSpi.transfer16(value);
     }
 
+    /**
+     * Transfer an array of 16-bit values (e.g. RGB565 pixels), each in
+     * big-endian wire order (MSB first). The values are byte-swapped into a
+     * small buffer on the stack, which is sent using a single
+     * `SPIClass::transfer(buf, n)` (or `writeBytes()` on ESP8266 and ESP32),
+     * instead of one transfer16() call per value.
+     */
+    void transfer16Array(const uint16_t* values, uint16_t count) const {
+      uint8_t buffer[kBurstSize];
+      while (count > 0) {
+        uint8_t n = (count > kBurstSize / 2) ? kBurstSize / 2 : count;
+        for (uint8_t i = 0; i < n; i++) {
+          buffer[2 * i] = (uint8_t) (values[i] >> 8);
+          buffer[2 * i + 1] = (uint8_t) values[i];
+        }
+      #if defined(ESP8266) || defined(ESP32)
+        mSpi.writeBytes(buffer, 2 * n);
+      #else
+        mSpi.transfer(buffer, 2 * n);
+      #endif
+        values += n;
+        count -= n;
+      }
+    }
+
     /** Convenience method to send 8 bits a single transaction. */
     void send8(uint8_t value) const {
       beginTransaction();
@@ -145,11 +174,105 @@ class HardSpiFastInterface {
       endTransaction();
     }
 
+    /**
+     * Convenience method to send a fixed sequence of bytes in a single
+     * transaction, e.g. `send(opcode, arg1, arg2)`. The arguments are expanded
+     * at compile-time into a straight sequence of transfer() calls, without
+     * copying them into a temporary array.
+     */
+    template <typename... T_ARGS>
+    void send(uint8_t value, T_ARGS... values) const {
+      static_assert(areByteArgs<T_ARGS...>::value,
+          "send() sends 1 byte per argument; cast wider values to uint8_t");
+      beginTransaction();
+      transferEach(value, values...);
+      endTransaction();
+    }
+
+    /**
+     * Send an array of (register, value) pairs, e.g. to initialize or refresh
+     * a MAX7219. The SPI settings are applied only once for the entire array,
+     * instead of once per pair. The latch is pulsed after every `pairsPerLatch`
+     * pairs, which is the minimum allowed by devices that latch a 16-bit
+     * register write on the rising edge of CS/SS. For a chain of N
+     * daisy-chained devices, `pairsPerLatch` should be N, and each group of N
+     * pairs should be ordered starting with the device furthest along the
+     * chain.
+     *
+     * @param pairs array of `2 * numPairs` bytes: {reg0, value0, reg1,
+     *    value1, ...}
+     * @param numPairs number of (register, value) pairs
+     * @param pairsPerLatch number of pairs shifted out between latch pulses,
+     *    default 1
+     */
+    void sendRegisters(
+        const uint8_t* pairs,
+        uint8_t numPairs,
+        uint8_t pairsPerLatch = 1
+    ) const {
+      if (pairsPerLatch == 0) pairsPerLatch = 1;
+      mSpi.beginTransaction(SPISettings(T_CLOCK_SPEED, kBitOrder, kSpiMode));
+      for (uint8_t i = 0; i < numPairs; ) {
+        digitalWriteFast(T_LATCH_PIN, LOW);
+        for (uint8_t j = 0; j < pairsPerLatch && i < numPairs; j++, i++) {
+          uint16_t value = ((uint16_t) pairs[0]) << 8 | (uint16_t) pairs[1];
+          mSpi.transfer16(value);
+          pairs += 2;
+        }
+        digitalWriteFast(T_LATCH_PIN, HIGH);
+      }
+      mSpi.endTransaction();
+    }
+
+    /**
+     * Send `count` bytes returned by successive calls to `generator()` in a
+     * single transaction, without an intermediate array. The generator is any
+     * function object (e.g. a lambda) whose `operator()` returns the next
+     * byte, and is usually inlined by the compiler.
+     *
+     * On AVR, the bytes are written directly into the SPDR register of the
+     * hardware SPI, and the next byte is generated while the current byte is
+     * shifted out.
+     */
+    template <typename T_GENERATOR>
+    void sendGenerated(T_GENERATOR&& generator, uint16_t count) const {
+      beginTransaction();
+    #if defined(ARDUINO_ARCH_AVR)
+      // Write SPDR directly, so that the next byte is generated while the
+      // current byte is shifted out.
+      if (count > 0) {
+        uint8_t value = generator();
+        for (uint16_t i = 1; i < count; i++) {
+          SPDR = value;
+          value = generator();
+          while (! (SPSR & _BV(SPIF))) {}
+        }
+        SPDR = value;
+        while (! (SPSR & _BV(SPIF))) {}
+      }
+    #else
+      for (uint16_t i = 0; i < count; i++) {
+        mSpi.transfer(generator());
+      }
+    #endif
+      endTransaction();
+    }
+
     // Use default copy constructor and assignment operator.
     HardSpiFastInterface(const HardSpiFastInterface&) = default;
     HardSpiFastInterface& operator=(const HardSpiFastInterface&) = default;
 
   private:
+    /** Terminate the recursion of transferEach(). */
+    void transferEach() const {}
+
+    /** Transfer each argument in order. */
+    template <typename... T_ARGS>
+    void transferEach(uint8_t value, T_ARGS... values) const {
+      transfer(value);
+      transferEach(values...);
+    }
+
     T_SPI& mSpi;
 };
 
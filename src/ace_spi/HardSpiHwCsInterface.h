@@ -0,0 +1,335 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#ifndef ACE_SPI_HARD_SPI_HW_CS_INTERFACE_H
+#define ACE_SPI_HARD_SPI_HW_CS_INTERFACE_H
+
+#include <stdint.h>
+#include <Arduino.h>
+#include <SPI.h>
+#include "ByteArgs.h"
+
+namespace ace_spi {
+
+/**
+ * Hardware SPI interface for the ESP8266 and ESP32 in which the SPI peripheral
+ * asserts the CS/SS pin itself, instead of the software toggling the latch
+ * pin using digitalWrite(). The bytes of each transaction are collected into
+ * a 64-byte buffer, then sent using a single `SPIClass::writeBytes()` call,
+ * which the peripheral executes as a single command with CS/SS held LOW for
+ * its duration.
+ *
+ * The CS/SS pin is fixed by the hardware: GPIO15 on the ESP8266, and the `ss`
+ * pin given to `SPIClass::begin()` on the ESP32 (default `SS`, GPIO5 on the
+ * VSPI bus).
+ *
+ * A peripheral command holds at most 64 bytes, and splitting a longer
+ * transaction into multiple commands would release the CS/SS pin between them.
+ * When a transaction grows beyond 64 bytes, the hardware control of CS/SS is
+ * disabled, the pin is pulled LOW using digitalWrite(), and the bytes are sent
+ * in 64-byte chunks until endTransaction() pulls it HIGH again and restores
+ * the hardware control. Long transactions (e.g. rows of pixels) are therefore
+ * sent correctly, at the cost of the 2 GPIO calls that this class normally
+ * saves. They are counted by getOverflowCount().
+ *
+ * Each instance contains the 64-byte buffer and the state of the current
+ * transaction, so it cannot be copied. It must be stored by reference by the
+ * objects which use it. Since the bytes are sent only at the end of the
+ * transaction, it cannot be used with helper classes which toggle a pin within
+ * a transaction (TftWindowWriter, Ssd1306Framebuffer).
+ *
+ * @tparam T_SPI the class of the hardware SPI instance, usually SPIClass
+ * @tparam T_CLOCK_SPEED the SPI clock speed, default 8000000 (8 MHz)
+ */
+template <
+    typename T_SPI,
+    uint32_t T_CLOCK_SPEED = 8000000
+>
+class HardSpiHwCsInterface {
+  private:
+    /** MSB first or LSB first */
+    static const uint8_t kBitOrder = MSBFIRST;
+
+    /** SPI mode */
+    static const uint8_t kSpiMode = SPI_MODE0;
+
+    /** Size of the buffer, equal to the data buffer of the peripheral. */
+    static const uint8_t kBufferSize = 64;
+
+  public:
+    /**
+     * The bytes are sent in endTransaction(), so transfer() returns before
+     * they are shifted out. See isBufferedTransfer.
+     */
+    static const bool kBufferedTransfer = true;
+
+    /**
+     * Constructor.
+     *
+     * @param spi instance of the `T_SPI` class. If the pre-installed `<SPI.h>`
+     *    is used, `T_SPI` is `SPIClass` and `spi` will be the pre-defined `SPI`
+     *    object.
+     * @param csPin the CS/SS pin asserted by the peripheral, driven using
+     *    digitalWrite() only for transactions longer than 64 bytes, default
+     *    `SS`
+     */
+    explicit HardSpiHwCsInterface(T_SPI& spi, uint8_t csPin = SS) :
+        mSpi(spi),
+        mCsPin(csPin)
+    {}
+
+    /**
+     * Initialize the HardSpiHwCsInterface. The hardware SPI object must be
+     * initialized using `SPI.begin()` before calling this. Enables the
+     * hardware control of the CS/SS pin.
+     */
+    void begin() const {
+      mSpi.setHwCs(true);
+    }
+
+    /** Clean up the object. Disables the hardware control of CS/SS. */
+    void end() const {
+      mSpi.setHwCs(false);
+    }
+
+    /** Begin SPI transaction. The CS/SS pin is not touched. */
+    void beginTransaction() const {
+      mSpi.beginTransaction(SPISettings(T_CLOCK_SPEED, kBitOrder, kSpiMode));
+      mCount = 0;
+    }
+
+    /**
+     * End SPI transaction. Send the buffered bytes as a single peripheral
+     * command, during which the peripheral holds CS/SS LOW. If the transaction
+     * was longer than 64 bytes, send the remaining bytes, then release the
+     * CS/SS pin.
+     */
+    void endTransaction() const {
+      flush();
+      mSpi.endTransaction();
+      if (mSoftwareCs) releaseSoftwareCs();
+    }
+
+    /**
+     * Transfer 8 bits. The byte is buffered until the transaction ends. If the
+     * buffer is full, it is sent first under software control of CS/SS.
+     */
+    void transfer(uint8_t value) const {
+      if (mCount == kBufferSize) spill();
+      mBuffer[mCount++] = value;
+    }
+
+    /** Transfer 16 bits. */
+    void transfer16(uint16_t value) const {
+      transfer((uint8_t) (value >> 8));
+      transfer((uint8_t) value);
+    }
+
+    /**
+     * Transfer an array of 16-bit values (e.g. RGB565 pixels), each in
+     * big-endian wire order (MSB first).
+     */
+    void transfer16Array(const uint16_t* values, uint16_t count) const {
+      for (uint16_t i = 0; i < count; i++) {
+        transfer16(values[i]);
+      }
+    }
+
+    /** Convenience method to send 8 bits a single transaction. */
+    void send8(uint8_t value) const {
+      beginTransaction();
+      transfer(value);
+      endTransaction();
+    }
+
+    /** Convenience method to send 16 bits a single transaction. */
+    void send16(uint16_t value) const {
+      beginTransaction();
+      transfer16(value);
+      endTransaction();
+    }
+
+    /** Convenience method to send 16 bits a single transaction. */
+    void send16(uint8_t msb, uint8_t lsb) const {
+      beginTransaction();
+      transfer(msb);
+      transfer(lsb);
+      endTransaction();
+    }
+
+    /**
+     * Convenience method to send a fixed sequence of bytes in a single
+     * transaction, e.g. `send(opcode, arg1, arg2)`. The arguments are expanded
+     * at compile-time into a straight sequence of transfer() calls, without
+     * copying them into a temporary array.
+     */
+    template <typename... T_ARGS>
+    void send(uint8_t value, T_ARGS... values) const {
+      static_assert(areByteArgs<T_ARGS...>::value,
+          "send() sends 1 byte per argument; cast wider values to uint8_t");
+      beginTransaction();
+      transferEach(value, values...);
+      endTransaction();
+    }
+
+    /**
+     * Send an array of (register, value) pairs, e.g. to initialize or refresh
+     * a MAX7219. The SPI settings are applied only once for the entire array.
+     * Each group of `pairsPerLatch` pairs is sent as a single peripheral
+     * command, so the CS/SS pin is pulsed by the hardware after each group.
+     * A group larger than 32 pairs is sent under software control of CS/SS,
+     * and counted as an overflow.
+     *
+     * @param pairs array of `2 * numPairs` bytes: {reg0, value0, reg1,
+     *    value1, ...}
+     * @param numPairs number of (register, value) pairs
+     * @param pairsPerLatch number of pairs shifted out between latch pulses,
+     *    default 1
+     */
+    void sendRegisters(
+        const uint8_t* pairs,
+        uint8_t numPairs,
+        uint8_t pairsPerLatch = 1
+    ) const {
+      if (pairsPerLatch == 0) pairsPerLatch = 1;
+      mSpi.beginTransaction(SPISettings(T_CLOCK_SPEED, kBitOrder, kSpiMode));
+      mCount = 0;
+      for (uint8_t i = 0; i < numPairs; ) {
+        for (uint8_t j = 0; j < pairsPerLatch && i < numPairs; j++, i++) {
+          transfer(pairs[0]);
+          transfer(pairs[1]);
+          pairs += 2;
+        }
+        flush();
+        if (mSoftwareCs) {
+          mSpi.endTransaction();
+          releaseSoftwareCs();
+          mSpi.beginTransaction(
+              SPISettings(T_CLOCK_SPEED, kBitOrder, kSpiMode));
+        }
+      }
+      mSpi.endTransaction();
+    }
+
+    /**
+     * Send `count` bytes returned by successive calls to `generator()` in a
+     * single transaction, without an intermediate array. The generator is any
+     * function object (e.g. a lambda) whose `operator()` returns the next
+     * byte, and is usually inlined by the compiler.
+     *
+     * The bytes are collected into the internal buffer. A sequence longer than
+     * 64 bytes is sent under software control of CS/SS, and counted as an
+     * overflow.
+     */
+    template <typename T_GENERATOR>
+    void sendGenerated(T_GENERATOR&& generator, uint16_t count) const {
+      beginTransaction();
+      for (uint16_t i = 0; i < count; i++) {
+        transfer(generator());
+      }
+      endTransaction();
+    }
+
+    /**
+     * Number of transactions (or sendRegisters() groups) longer than 64 bytes,
+     * which were sent under software control of CS/SS.
+     */
+    uint16_t getOverflowCount() const { return mOverflowCount; }
+
+  private:
+    // disable copy constructor and assignment operator
+    HardSpiHwCsInterface(const HardSpiHwCsInterface&) = delete;
+    HardSpiHwCsInterface& operator=(const HardSpiHwCsInterface&) = delete;
+
+    /** Terminate the recursion of transferEach(). */
+    void transferEach() const {}
+
+    /** Transfer each argument in order. */
+    template <typename... T_ARGS>
+    void transferEach(uint8_t value, T_ARGS... values) const {
+      transfer(value);
+      transferEach(values...);
+    }
+
+    /**
+     * Send the full buffer in the middle of a transaction. Nothing has been
+     * sent yet on the first call, so the CS/SS pin is still idle, and can be
+     * taken over by digitalWrite() before the first chunk. On the ESP32,
+     * setHwCs() takes the bus mutex held by the SPIClass transaction, so the
+     * transaction is closed around it.
+     */
+    void spill() const {
+      if (! mSoftwareCs) {
+        mSpi.endTransaction();
+        mSpi.setHwCs(false);
+        pinMode(mCsPin, OUTPUT);
+        digitalWrite(mCsPin, LOW);
+        mSpi.beginTransaction(SPISettings(T_CLOCK_SPEED, kBitOrder, kSpiMode));
+        mSoftwareCs = true;
+        mOverflowCount++;
+      }
+      mSpi.writeBytes(mBuffer, mCount);
+      mCount = 0;
+    }
+
+    /** Send the buffered bytes as a single peripheral command. */
+    void flush() const {
+      if (mCount > 0) {
+        mSpi.writeBytes(mBuffer, mCount);
+      }
+      mCount = 0;
+    }
+
+    /**
+     * Release the CS/SS pin after an oversize transaction, and give it back to
+     * the peripheral. Must be called outside of the SPIClass transaction.
+     */
+    void releaseSoftwareCs() const {
+      digitalWrite(mCsPin, HIGH);
+      mSpi.setHwCs(true);
+      mSoftwareCs = false;
+    }
+
+    T_SPI& mSpi;
+
+    /** CS/SS pin, driven by software only for oversize transactions. */
+    uint8_t const mCsPin;
+
+    /** Bytes of the current transaction. */
+    mutable uint8_t mBuffer[kBufferSize];
+
+    /** Number of bytes in mBuffer. */
+    mutable uint8_t mCount = 0;
+
+    /** Set while CS/SS is driven by software for an oversize transaction. */
+    mutable bool mSoftwareCs = false;
+
+    /** Number of transactions sent under software control of CS/SS. */
+    mutable uint16_t mOverflowCount = 0;
+};
+
+} // ace_spi
+
+#endif
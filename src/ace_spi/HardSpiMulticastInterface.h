@@ -0,0 +1,333 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#ifndef ACE_SPI_HARD_SPI_MULTICAST_INTERFACE_H
+#define ACE_SPI_HARD_SPI_MULTICAST_INTERFACE_H
+
+#include <stdint.h>
+#include <Arduino.h> // digitalWrite()
+#include <SPI.h>
+#include "ByteArgs.h"
+
+namespace ace_spi {
+
+/**
+ * Hardware SPI interface which sends the same payload to several identical
+ * write-only devices at once, by pulling all of their latch (CS/SS) pins LOW
+ * together, shifting out the payload once, then releasing the latch pins
+ * together. It implements the same unified interface as HardSpiInterface, so a
+ * device driver templatized on the interface broadcasts to all devices
+ * without modification.
+ *
+ * On AVR processors, if all latch pins are on the same port, they are
+ * asserted and released using a single write to the port register. Otherwise,
+ * each latch pin is written using digitalWrite().
+ *
+ * The devices must not drive MISO, since they are all selected at the same
+ * time.
+ *
+ * @tparam T_SPI the class of the hardware SPI instance, usually SPIClass
+ * @tparam T_CLOCK_SPEED the SPI clock speed, default 8000000 (8 MHz)
+ */
+template <
+    typename T_SPI,
+    uint32_t T_CLOCK_SPEED = 8000000
+>
+class HardSpiMulticastInterface {
+  private:
+    /** MSB first or LSB first */
+  #if defined(ARDUINO_ARCH_STM32) || defined(ARDUINO_ARCH_SAMD)
+    static const BitOrder kBitOrder = MSBFIRST;
+  #else
+    static const uint8_t kBitOrder = MSBFIRST;
+  #endif
+
+    /** SPI mode */
+    static const uint8_t kSpiMode = SPI_MODE0;
+
+    /** Size of the stack buffer used by transfer16Array(). */
+    static const uint8_t kBurstSize = 32;
+
+  public:
+    /**
+     * Constructor.
+     *
+     * @param spi instance of the `T_SPI` class. If the pre-installed `<SPI.h>`
+     *    is used, `T_SPI` is `SPIClass` and `spi` will be the pre-defined `SPI`
+     *    object.
+     * @param latchPins array of the pins that control the CS/SS pins of the
+     *    slave devices. The array is not copied, so it must outlive this
+     *    object.
+     * @param numLatchPins number of elements in `latchPins`
+     */
+    explicit HardSpiMulticastInterface(
+        T_SPI& spi,
+        const uint8_t* latchPins,
+        uint8_t numLatchPins
+    ) :
+        mSpi(spi),
+        mLatchPins(latchPins),
+        mNumLatchPins(numLatchPins)
+    {}
+
+    /**
+     * Initialize the HardSpiMulticastInterface. The hardware SPI object must be
+     * initialized using `SPI.begin()` as well.
+     */
+    void begin() const {
+      #if defined(ESP8266)
+        mSpi.setHwCs(false);
+      #endif
+
+      for (uint8_t i = 0; i < mNumLatchPins; i++) {
+        digitalWrite(mLatchPins[i], HIGH);
+        pinMode(mLatchPins[i], OUTPUT);
+      }
+
+      #if defined(ARDUINO_ARCH_AVR)
+        // Use a single port write if all latch pins are on the same port.
+        mPort = nullptr;
+        mMask = 0;
+        if (mNumLatchPins == 0) return;
+        uint8_t port = digitalPinToPort(mLatchPins[0]);
+        for (uint8_t i = 0; i < mNumLatchPins; i++) {
+          if (digitalPinToPort(mLatchPins[i]) != port) return;
+          mMask |= digitalPinToBitMask(mLatchPins[i]);
+        }
+        mPort = portOutputRegister(port);
+      #endif
+    }
+
+    /** Clean up the object. */
+    void end() const {
+      for (uint8_t i = 0; i < mNumLatchPins; i++) {
+        pinMode(mLatchPins[i], INPUT);
+      }
+    }
+
+    /** Begin SPI transaction. Pull all latches LOW. */
+    void beginTransaction() const {
+      mSpi.beginTransaction(SPISettings(T_CLOCK_SPEED, kBitOrder, kSpiMode));
+      writeLatches(LOW);
+    }
+
+    /** End SPI transaction. Pull all latches HIGH. */
+    void endTransaction() const {
+      writeLatches(HIGH);
+      mSpi.endTransaction();
+    }
+
+    /** Transfer 8 bits. */
+    void transfer(uint8_t value) const {
+      mSpi.transfer(value);
+    }
+
+    /** Transfer 16 bits. */
+    void transfer16(uint16_t value) const {
+      mSpi.transfer16(value);
+    }
+
+    /**
+     * Transfer an array of 16-bit values (e.g. RGB565 pixels), each in
+     * big-endian wire order (MSB first). The values are byte-swapped into a
+     * small buffer on the stack, which is sent using a single
+     * `SPIClass::transfer(buf, n)` (or `writeBytes()` on ESP8266 and ESP32),
+     * instead of one transfer16() call per value. The values are always sent
+     * as 8-bit frames, including on the STM32, where the HardSpiStm32Interface
+     * should be used to send them as 16-bit frames without the byte swap.
+     */
+    void transfer16Array(const uint16_t* values, uint16_t count) const {
+      uint8_t buffer[kBurstSize];
+      while (count > 0) {
+        uint8_t n = (count > kBurstSize / 2) ? kBurstSize / 2 : count;
+        for (uint8_t i = 0; i < n; i++) {
+          buffer[2 * i] = (uint8_t) (values[i] >> 8);
+          buffer[2 * i + 1] = (uint8_t) values[i];
+        }
+      #if defined(ESP8266) || defined(ESP32)
+        mSpi.writeBytes(buffer, 2 * n);
+      #else
+        mSpi.transfer(buffer, 2 * n);
+      #endif
+        values += n;
+        count -= n;
+      }
+    }
+
+    /** Convenience method to send 8 bits a single transaction. */
+    void send8(uint8_t value) const {
+      beginTransaction();
+      transfer(value);
+      endTransaction();
+    }
+
+    /** Convenience method to send 16 bits a single transaction. */
+    void send16(uint16_t value) const {
+      beginTransaction();
+      transfer16(value);
+      endTransaction();
+    }
+
+    /** Convenience method to send 16 bits a single transaction. */
+    void send16(uint8_t msb, uint8_t lsb) const {
+      beginTransaction();
+      uint16_t value = ((uint16_t) msb) << 8 | (uint16_t) lsb;
+      transfer16(value);
+      endTransaction();
+    }
+
+    /**
+     * Convenience method to send a fixed sequence of bytes in a single
+     * transaction, e.g. `send(opcode, arg1, arg2)`. The arguments are expanded
+     * at compile-time into a straight sequence of transfer() calls, without
+     * copying them into a temporary array.
+     */
+    template <typename... T_ARGS>
+    void send(uint8_t value, T_ARGS... values) const {
+      static_assert(areByteArgs<T_ARGS...>::value,
+          "send() sends 1 byte per argument; cast wider values to uint8_t");
+      beginTransaction();
+      transferEach(value, values...);
+      endTransaction();
+    }
+
+    /**
+     * Send an array of (register, value) pairs to all devices. The SPI
+     * settings are applied only once for the entire array. All latches are
+     * pulsed after every `pairsPerLatch` pairs.
+     *
+     * @param pairs array of `2 * numPairs` bytes: {reg0, value0, reg1,
+     *    value1, ...}
+     * @param numPairs number of (register, value) pairs
+     * @param pairsPerLatch number of pairs shifted out between latch pulses,
+     *    default 1
+     */
+    void sendRegisters(
+        const uint8_t* pairs,
+        uint8_t numPairs,
+        uint8_t pairsPerLatch = 1
+    ) const {
+      if (pairsPerLatch == 0) pairsPerLatch = 1;
+      mSpi.beginTransaction(SPISettings(T_CLOCK_SPEED, kBitOrder, kSpiMode));
+      for (uint8_t i = 0; i < numPairs; ) {
+        writeLatches(LOW);
+        for (uint8_t j = 0; j < pairsPerLatch && i < numPairs; j++, i++) {
+          uint16_t value = ((uint16_t) pairs[0]) << 8 | (uint16_t) pairs[1];
+          mSpi.transfer16(value);
+          pairs += 2;
+        }
+        writeLatches(HIGH);
+      }
+      mSpi.endTransaction();
+    }
+
+    /**
+     * Send `count` bytes returned by successive calls to `generator()` in a
+     * single transaction, without an intermediate array. The generator is any
+     * function object (e.g. a lambda) whose `operator()` returns the next
+     * byte, and is usually inlined by the compiler.
+     *
+     * On AVR, the bytes are written directly into the SPDR register of the
+     * hardware SPI, and the next byte is generated while the current byte is
+     * shifted out.
+     */
+    template <typename T_GENERATOR>
+    void sendGenerated(T_GENERATOR&& generator, uint16_t count) const {
+      beginTransaction();
+    #if defined(ARDUINO_ARCH_AVR)
+      // Write SPDR directly, so that the next byte is generated while the
+      // current byte is shifted out.
+      if (count > 0) {
+        uint8_t value = generator();
+        for (uint16_t i = 1; i < count; i++) {
+          SPDR = value;
+          value = generator();
+          while (! (SPSR & _BV(SPIF))) {}
+        }
+        SPDR = value;
+        while (! (SPSR & _BV(SPIF))) {}
+      }
+    #else
+      for (uint16_t i = 0; i < count; i++) {
+        mSpi.transfer(generator());
+      }
+    #endif
+      endTransaction();
+    }
+
+    // Use default copy constructor and assignment operator.
+    HardSpiMulticastInterface(const HardSpiMulticastInterface&) = default;
+    HardSpiMulticastInterface& operator=(const HardSpiMulticastInterface&)
+        = default;
+
+  private:
+    /** Terminate the recursion of transferEach(). */
+    void transferEach() const {}
+
+    /** Transfer each argument in order. */
+    template <typename... T_ARGS>
+    void transferEach(uint8_t value, T_ARGS... values) const {
+      transfer(value);
+      transferEach(values...);
+    }
+
+    /** Write `level` to all latch pins, using one port write if possible. */
+    void writeLatches(uint8_t level) const {
+    #if defined(ARDUINO_ARCH_AVR)
+      if (mPort) {
+        // Other pins on the port may be written from an ISR.
+        uint8_t oldSREG = SREG;
+        cli();
+        if (level) {
+          *mPort |= mMask;
+        } else {
+          *mPort &= ~mMask;
+        }
+        SREG = oldSREG;
+        return;
+      }
+    #endif
+
+      for (uint8_t i = 0; i < mNumLatchPins; i++) {
+        digitalWrite(mLatchPins[i], level);
+      }
+    }
+
+    T_SPI& mSpi;
+    const uint8_t* const mLatchPins;
+    uint8_t const mNumLatchPins;
+
+  #if defined(ARDUINO_ARCH_AVR)
+    /** Output register of the latch pins, or nullptr if on different ports. */
+    mutable volatile uint8_t* mPort = nullptr;
+
+    /** Bit mask of the latch pins in mPort. */
+    mutable uint8_t mMask = 0;
+  #endif
+};
+
+} // ace_spi
+
+#endif
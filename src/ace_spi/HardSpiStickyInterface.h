@@ -0,0 +1,316 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#ifndef ACE_SPI_HARD_SPI_STICKY_INTERFACE_H
+#define ACE_SPI_HARD_SPI_STICKY_INTERFACE_H
+
+#include <stdint.h>
+#include <Arduino.h> // digitalWrite()
+#include <SPI.h>
+#include "SpiBusOwner.h"
+#include "ByteArgs.h"
+
+namespace ace_spi {
+
+/**
+ * Hardware SPI interface which keeps its device selected (latch LOW) and the
+ * SPI settings active between transactions, for devices which tolerate CS/SS
+ * staying LOW between commands. A stream of short commands then costs only
+ * the transfer of the bytes, instead of a `SPIClass::beginTransaction()`,
+ * `endTransaction()` and 2 `digitalWrite()` calls per command.
+ *
+ * The first beginTransaction() acquires the bus through the shared
+ * SpiBusOwner, releasing the device which previously held it. The
+ * endTransaction() does nothing. The device stays selected until another
+ * device acquires the bus, or release() is called. A transfer() by a device
+ * which does not hold the bus (i.e. without a beginTransaction() after
+ * another device took the bus) is rejected and counted by
+ * SpiBusOwner::getViolationCount(), instead of being sent to the wrong
+ * device.
+ *
+ * Since the `SPIClass` transaction stays open, interrupt handlers which use
+ * the same bus through `SPI.usingInterrupt()` are blocked until release() is
+ * called.
+ *
+ * @tparam T_SPI the class of the hardware SPI instance, usually SPIClass
+ * @tparam T_CLOCK_SPEED the SPI clock speed, default 8000000 (8 MHz)
+ */
+template <
+    typename T_SPI,
+    uint32_t T_CLOCK_SPEED = 8000000
+>
+class HardSpiStickyInterface {
+  private:
+    /** MSB first or LSB first */
+  #if defined(ARDUINO_ARCH_STM32) || defined(ARDUINO_ARCH_SAMD)
+    static const BitOrder kBitOrder = MSBFIRST;
+  #else
+    static const uint8_t kBitOrder = MSBFIRST;
+  #endif
+
+    /** SPI mode */
+    static const uint8_t kSpiMode = SPI_MODE0;
+
+    /** Size of the stack buffer used by transfer16Array(). */
+    static const uint8_t kBurstSize = 32;
+
+  public:
+    /**
+     * Constructor.
+     *
+     * @param spi instance of the `T_SPI` class. If the pre-installed `<SPI.h>`
+     *    is used, `T_SPI` is `SPIClass` and `spi` will be the pre-defined `SPI`
+     *    object.
+     * @param busOwner the SpiBusOwner shared by all devices on `spi`
+     * @param latchPin the pin that controls the CS/SS pin of the slave device
+     */
+    explicit HardSpiStickyInterface(
+        T_SPI& spi,
+        SpiBusOwner& busOwner,
+        uint8_t latchPin
+    ) :
+        mSpi(spi),
+        mBusOwner(busOwner),
+        mLatchPin(latchPin)
+    {}
+
+    /**
+     * Initialize the HardSpiStickyInterface. The hardware SPI object must be
+     * initialized using `SPI.begin()` as well.
+     */
+    void begin() const {
+      #if defined(ESP8266)
+        mSpi.setHwCs(false);
+      #endif
+
+      digitalWrite(mLatchPin, HIGH);
+      pinMode(mLatchPin, OUTPUT);
+    }
+
+    /** Release the bus, then clean up the object. */
+    void end() const {
+      release();
+      pinMode(mLatchPin, INPUT);
+    }
+
+    /**
+     * Begin SPI transaction. If this device does not already hold the bus,
+     * release the previous owner, apply the SPI settings, and pull latch LOW.
+     */
+    void beginTransaction() const {
+      if (mBusOwner.acquire(mLatchPin, &releaseOwner, &mSpi)) return;
+      mSpi.beginTransaction(SPISettings(T_CLOCK_SPEED, kBitOrder, kSpiMode));
+      digitalWrite(mLatchPin, LOW);
+    }
+
+    /** End SPI transaction. Does nothing, the device stays selected. */
+    void endTransaction() const {}
+
+    /**
+     * Deselect the device (latch HIGH) and end the `SPIClass` transaction, if
+     * this device holds the bus.
+     */
+    void release() const {
+      if (mBusOwner.isOwner(mLatchPin)) mBusOwner.release();
+    }
+
+    /** Return true if this device currently holds the bus. */
+    bool isSelected() const { return mBusOwner.isOwner(mLatchPin); }
+
+    /** Transfer 8 bits, if this device holds the bus. */
+    void transfer(uint8_t value) const {
+      if (! mBusOwner.isOwner(mLatchPin)) {
+        mBusOwner.recordViolation();
+        return;
+      }
+      mSpi.transfer(value);
+    }
+
+    /** Transfer 16 bits, if this device holds the bus. */
+    void transfer16(uint16_t value) const {
+      if (! mBusOwner.isOwner(mLatchPin)) {
+        mBusOwner.recordViolation();
+        return;
+      }
+      mSpi.transfer16(value);
+    }
+
+    /**
+     * Transfer an array of 16-bit values (e.g. RGB565 pixels), each in
+     * big-endian wire order (MSB first). The values are byte-swapped into a
+     * small buffer on the stack, which is sent using a single
+     * `SPIClass::transfer(buf, n)` (or `writeBytes()` on ESP8266 and ESP32),
+     * instead of one transfer16() call per value. The values are always sent
+     * as 8-bit frames, including on the STM32, where the HardSpiStm32Interface
+     * should be used to send them as 16-bit frames without the byte swap.
+     */
+    void transfer16Array(const uint16_t* values, uint16_t count) const {
+      if (! mBusOwner.isOwner(mLatchPin)) {
+        mBusOwner.recordViolation();
+        return;
+      }
+      uint8_t buffer[kBurstSize];
+      while (count > 0) {
+        uint8_t n = (count > kBurstSize / 2) ? kBurstSize / 2 : count;
+        for (uint8_t i = 0; i < n; i++) {
+          buffer[2 * i] = (uint8_t) (values[i] >> 8);
+          buffer[2 * i + 1] = (uint8_t) values[i];
+        }
+      #if defined(ESP8266) || defined(ESP32)
+        mSpi.writeBytes(buffer, 2 * n);
+      #else
+        mSpi.transfer(buffer, 2 * n);
+      #endif
+        values += n;
+        count -= n;
+      }
+    }
+
+    /** Convenience method to send 8 bits a single transaction. */
+    void send8(uint8_t value) const {
+      beginTransaction();
+      mSpi.transfer(value);
+    }
+
+    /** Convenience method to send 16 bits a single transaction. */
+    void send16(uint16_t value) const {
+      beginTransaction();
+      mSpi.transfer16(value);
+    }
+
+    /** Convenience method to send 16 bits a single transaction. */
+    void send16(uint8_t msb, uint8_t lsb) const {
+      beginTransaction();
+      uint16_t value = ((uint16_t) msb) << 8 | (uint16_t) lsb;
+      mSpi.transfer16(value);
+    }
+
+    /**
+     * Convenience method to send a fixed sequence of bytes in a single
+     * transaction, e.g. `send(opcode, arg1, arg2)`. The arguments are expanded
+     * at compile-time into a straight sequence of transfer() calls, without
+     * copying them into a temporary array.
+     */
+    template <typename... T_ARGS>
+    void send(uint8_t value, T_ARGS... values) const {
+      static_assert(areByteArgs<T_ARGS...>::value,
+          "send() sends 1 byte per argument; cast wider values to uint8_t");
+      beginTransaction();
+      transferEach(value, values...);
+    }
+
+    /**
+     * Send an array of (register, value) pairs. The latch is pulsed HIGH then
+     * LOW after every `pairsPerLatch` pairs, so that devices which latch a
+     * register write on the rising edge of CS/SS see the edge, and the device
+     * stays selected afterwards.
+     *
+     * @param pairs array of `2 * numPairs` bytes: {reg0, value0, reg1,
+     *    value1, ...}
+     * @param numPairs number of (register, value) pairs
+     * @param pairsPerLatch number of pairs shifted out between latch pulses,
+     *    default 1
+     */
+    void sendRegisters(
+        const uint8_t* pairs,
+        uint8_t numPairs,
+        uint8_t pairsPerLatch = 1
+    ) const {
+      if (pairsPerLatch == 0) pairsPerLatch = 1;
+      beginTransaction();
+      for (uint8_t i = 0; i < numPairs; ) {
+        for (uint8_t j = 0; j < pairsPerLatch && i < numPairs; j++, i++) {
+          uint16_t value = ((uint16_t) pairs[0]) << 8 | (uint16_t) pairs[1];
+          mSpi.transfer16(value);
+          pairs += 2;
+        }
+        digitalWrite(mLatchPin, HIGH);
+        digitalWrite(mLatchPin, LOW);
+      }
+    }
+
+    /**
+     * Send `count` bytes returned by successive calls to `generator()` in a
+     * single transaction, without an intermediate array. The generator is any
+     * function object (e.g. a lambda) whose `operator()` returns the next
+     * byte, and is usually inlined by the compiler.
+     *
+     * On AVR, the bytes are written directly into the SPDR register of the
+     * hardware SPI, and the next byte is generated while the current byte is
+     * shifted out.
+     */
+    template <typename T_GENERATOR>
+    void sendGenerated(T_GENERATOR&& generator, uint16_t count) const {
+      beginTransaction();
+    #if defined(ARDUINO_ARCH_AVR)
+      // Write SPDR directly, so that the next byte is generated while the
+      // current byte is shifted out.
+      if (count > 0) {
+        uint8_t value = generator();
+        for (uint16_t i = 1; i < count; i++) {
+          SPDR = value;
+          value = generator();
+          while (! (SPSR & _BV(SPIF))) {}
+        }
+        SPDR = value;
+        while (! (SPSR & _BV(SPIF))) {}
+      }
+    #else
+      for (uint16_t i = 0; i < count; i++) {
+        mSpi.transfer(generator());
+      }
+    #endif
+      endTransaction();
+    }
+
+    // Use default copy constructor and assignment operator.
+    HardSpiStickyInterface(const HardSpiStickyInterface&) = default;
+    HardSpiStickyInterface& operator=(const HardSpiStickyInterface&) = default;
+
+  private:
+    /** Terminate the recursion of transferEach(). */
+    void transferEach() const {}
+
+    /** Transfer each argument in order. */
+    template <typename... T_ARGS>
+    void transferEach(uint8_t value, T_ARGS... values) const {
+      mSpi.transfer(value);
+      transferEach(values...);
+    }
+
+    /** Called by SpiBusOwner when another device acquires the bus. */
+    static void releaseOwner(void* context, uint8_t latchPin) {
+      digitalWrite(latchPin, HIGH);
+      static_cast<T_SPI*>(context)->endTransaction();
+    }
+
+    T_SPI& mSpi;
+    SpiBusOwner& mBusOwner;
+    uint8_t const mLatchPin;
+};
+
+} // ace_spi
+
+#endif
@@ -0,0 +1,310 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#ifndef ACE_SPI_HARD_SPI_STM32_INTERFACE_H
+#define ACE_SPI_HARD_SPI_STM32_INTERFACE_H
+
+#include <stdint.h>
+#include <Arduino.h> // digitalWrite()
+#include <SPI.h>
+#include "ByteArgs.h"
+
+namespace ace_spi {
+
+/**
+ * Hardware SPI interface for STM32 processors which bypasses the `SPIClass`
+ * for each transaction. On the STM32duino core, `SPIClass::beginTransaction()`
+ * and `SPIClass::transfer()` go through the HAL layer, whose overhead is so
+ * large that HardSpiInterface is no faster than SimpleSpiInterface.
+ *
+ * This class uses `SPIClass::beginTransaction()` only once in begin() to let
+ * the core configure the clock, the pins, and the SPI mode of the peripheral.
+ * After that, each transaction only toggles the latch pin, writes each byte
+ * to the `DR` register after waiting for `TXE`, then waits for `BSY` to clear
+ * before releasing the latch.
+ *
+ * This class assumes that it owns the SPI peripheral. If another device on
+ * the same bus uses the `SPIClass` object directly (e.g. through a
+ * HardSpiInterface), the peripheral will be reconfigured by the HAL, and
+ * begin() must be called again before using this object.
+ *
+ * The register block is a template parameter, normally `SPI_TypeDef` from the
+ * CMSIS headers (e.g. `SPI1`, `SPI2`). It must provide the `CR1`, `SR`, and
+ * `DR` registers, which is true of the STM32F0/F1/F2/F3/F4/F7/L0/L1/L4/G0/G4
+ * families, but not the STM32H7. Any struct with those members can be used,
+ * which allows the register sequence to be verified on a host machine.
+ *
+ * @tparam T_SPI the class of the hardware SPI instance, usually SPIClass
+ * @tparam T_REGS the class of the SPI register block, usually SPI_TypeDef
+ * @tparam T_CLOCK_SPEED the SPI clock speed, default 8000000 (8 MHz)
+ */
+template <
+    typename T_SPI,
+    typename T_REGS,
+    uint32_t T_CLOCK_SPEED = 8000000
+>
+class HardSpiStm32Interface {
+  private:
+    /** MSB first or LSB first */
+  #if defined(ARDUINO_ARCH_STM32) || defined(ARDUINO_ARCH_SAMD)
+    static const BitOrder kBitOrder = MSBFIRST;
+  #else
+    static const uint8_t kBitOrder = MSBFIRST;
+  #endif
+
+    /** SPI mode */
+    static const uint8_t kSpiMode = SPI_MODE0;
+
+    /** SPI enable bit (SPE) of the CR1 register. */
+    static const uint32_t kCr1Spe = 0x0040;
+
+    /** Transmit buffer empty bit (TXE) of the SR register. */
+    static const uint32_t kSrTxe = 0x0002;
+
+    /** Busy bit (BSY) of the SR register. */
+    static const uint32_t kSrBsy = 0x0080;
+
+    /** 16-bit data frame format bit (DFF) of the CR1 register. */
+    static const uint32_t kCr1Dff = 0x0800;
+
+  public:
+    /**
+     * The transfer() method returns as soon as the byte is written into the
+     * transmit buffer, before it is shifted out. See isBufferedTransfer.
+     */
+    static const bool kBufferedTransfer = true;
+
+    /**
+     * Constructor.
+     *
+     * @param spi instance of the `T_SPI` class, used only in begin() and end()
+     *    to configure the peripheral
+     * @param regs pointer to the register block of the same SPI peripheral
+     *    (e.g. `SPI1`, if the default `SPI` object of the board variant uses
+     *    the pins of SPI1)
+     * @param latchPin the pin that controls the CS/SS pin of the slave device
+     */
+    explicit HardSpiStm32Interface(T_SPI& spi, T_REGS* regs, uint8_t latchPin) :
+        mSpi(spi),
+        mRegs(regs),
+        mLatchPin(latchPin)
+    {}
+
+    /**
+     * Initialize the HardSpiStm32Interface. The hardware SPI object must be
+     * initialized using `SPI.begin()` before calling this. This configures the
+     * SPI peripheral using the `SPIClass` and leaves it enabled.
+     */
+    void begin() const {
+      pinMode(mLatchPin, OUTPUT);
+      mSpi.beginTransaction(SPISettings(T_CLOCK_SPEED, kBitOrder, kSpiMode));
+      mRegs->CR1 |= kCr1Spe;
+    }
+
+    /** Clean up the object. Releases the SPIClass transaction. */
+    void end() const {
+      mSpi.endTransaction();
+      pinMode(mLatchPin, INPUT);
+    }
+
+    /** Begin SPI transaction. Pull latch LOW. */
+    void beginTransaction() const {
+      digitalWrite(mLatchPin, LOW);
+    }
+
+    /**
+     * End SPI transaction. Wait for the last byte to be shifted out, then pull
+     * latch HIGH.
+     */
+    void endTransaction() const {
+      flush();
+      digitalWrite(mLatchPin, HIGH);
+    }
+
+    /** Transfer 8 bits. */
+    void transfer(uint8_t value) const {
+      while (! (mRegs->SR & kSrTxe)) {}
+      // Use an 8-bit access so that families with a data packing FIFO (e.g.
+      // STM32F0, L4, G0) send a single byte.
+      *((volatile uint8_t*) &mRegs->DR) = value;
+    }
+
+    /** Transfer 16 bits. */
+    void transfer16(uint16_t value) const {
+      transfer((uint8_t) (value >> 8));
+      transfer((uint8_t) value);
+    }
+
+    /**
+     * Transfer an array of 16-bit values (e.g. RGB565 pixels), each in
+     * big-endian wire order (MSB first). On the families whose CR1 register
+     * has the DFF bit (STM32F1, F2, F4, L1), the peripheral is switched to
+     * 16-bit frames for the duration of the array, so that each value is a
+     * single write to DR. On the other families, each value is sent as 2
+     * bytes.
+     */
+    void transfer16Array(const uint16_t* values, uint16_t count) const {
+    #if defined(SPI_CR1_DFF)
+      // DFF must be changed only while the peripheral is disabled.
+      flush();
+      mRegs->CR1 &= ~kCr1Spe;
+      mRegs->CR1 |= kCr1Dff;
+      mRegs->CR1 |= kCr1Spe;
+      for (uint16_t i = 0; i < count; i++) {
+        while (! (mRegs->SR & kSrTxe)) {}
+        mRegs->DR = values[i];
+      }
+      flush();
+      mRegs->CR1 &= ~kCr1Spe;
+      mRegs->CR1 &= ~kCr1Dff;
+      mRegs->CR1 |= kCr1Spe;
+    #else
+      for (uint16_t i = 0; i < count; i++) {
+        transfer16(values[i]);
+      }
+    #endif
+    }
+
+    /** Convenience method to send 8 bits a single transaction. */
+    void send8(uint8_t value) const {
+      beginTransaction();
+      transfer(value);
+      endTransaction();
+    }
+
+    /** Convenience method to send 16 bits a single transaction. */
+    void send16(uint16_t value) const {
+      beginTransaction();
+      transfer16(value);
+      endTransaction();
+    }
+
+    /** Convenience method to send 16 bits a single transaction. */
+    void send16(uint8_t msb, uint8_t lsb) const {
+      beginTransaction();
+      transfer(msb);
+      transfer(lsb);
+      endTransaction();
+    }
+
+    /**
+     * Convenience method to send a fixed sequence of bytes in a single
+     * transaction, e.g. `send(opcode, arg1, arg2)`. The arguments are expanded
+     * at compile-time into a straight sequence of transfer() calls, without
+     * copying them into a temporary array.
+     */
+    template <typename... T_ARGS>
+    void send(uint8_t value, T_ARGS... values) const {
+      static_assert(areByteArgs<T_ARGS...>::value,
+          "send() sends 1 byte per argument; cast wider values to uint8_t");
+      beginTransaction();
+      transferEach(value, values...);
+      endTransaction();
+    }
+
+    /**
+     * Send an array of (register, value) pairs, e.g. to initialize or refresh
+     * a MAX7219. The latch is pulsed after every `pairsPerLatch` pairs, which
+     * is the minimum allowed by devices that latch a 16-bit register write on
+     * the rising edge of CS/SS. The peripheral is already configured, so there
+     * is no per-pair settings overhead.
+     *
+     * @param pairs array of `2 * numPairs` bytes: {reg0, value0, reg1,
+     *    value1, ...}
+     * @param numPairs number of (register, value) pairs
+     * @param pairsPerLatch number of pairs shifted out between latch pulses,
+     *    default 1
+     */
+    void sendRegisters(
+        const uint8_t* pairs,
+        uint8_t numPairs,
+        uint8_t pairsPerLatch = 1
+    ) const {
+      if (pairsPerLatch == 0) pairsPerLatch = 1;
+      for (uint8_t i = 0; i < numPairs; ) {
+        beginTransaction();
+        for (uint8_t j = 0; j < pairsPerLatch && i < numPairs; j++, i++) {
+          transfer(pairs[0]);
+          transfer(pairs[1]);
+          pairs += 2;
+        }
+        endTransaction();
+      }
+    }
+
+    /**
+     * Send `count` bytes returned by successive calls to `generator()` in a
+     * single transaction, without an intermediate array. The generator is any
+     * function object (e.g. a lambda) whose `operator()` returns the next
+     * byte, and is usually inlined by the compiler.
+     *
+     * Each transfer() returns as soon as the byte is written into the transmit
+     * buffer, so the next byte is generated while the current byte is shifted
+     * out.
+     */
+    template <typename T_GENERATOR>
+    void sendGenerated(T_GENERATOR&& generator, uint16_t count) const {
+      beginTransaction();
+      for (uint16_t i = 0; i < count; i++) {
+        transfer(generator());
+      }
+      endTransaction();
+    }
+
+    // Use default copy constructor and assignment operator.
+    HardSpiStm32Interface(const HardSpiStm32Interface&) = default;
+    HardSpiStm32Interface& operator=(const HardSpiStm32Interface&) = default;
+
+  private:
+    /** Terminate the recursion of transferEach(). */
+    void transferEach() const {}
+
+    /** Transfer each argument in order. */
+    template <typename... T_ARGS>
+    void transferEach(uint8_t value, T_ARGS... values) const {
+      transfer(value);
+      transferEach(values...);
+    }
+
+    /**
+     * Wait until the last byte has been shifted out. Then read DR and SR to
+     * clear the RXNE and OVR flags caused by the bytes received in full-duplex
+     * mode, which are never read.
+     */
+    void flush() const {
+      while (! (mRegs->SR & kSrTxe)) {}
+      while (mRegs->SR & kSrBsy) {}
+      (void) mRegs->DR;
+      (void) mRegs->SR;
+    }
+
+    T_SPI& mSpi;
+    T_REGS* mRegs;
+    uint8_t mLatchPin;
+};
+
+} // ace_spi
+
+#endif
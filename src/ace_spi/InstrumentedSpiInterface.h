@@ -0,0 +1,214 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#ifndef ACE_SPI_INSTRUMENTED_SPI_INTERFACE_H
+#define ACE_SPI_INSTRUMENTED_SPI_INTERFACE_H
+
+#include <stdint.h>
+#include "BufferedTransfer.h"
+#include "ByteArgs.h"
+
+namespace ace_spi {
+
+/**
+ * A wrapper around one of the XxxInterface classes which forwards every call
+ * to the underlying interface, and notifies a monitor object at the start and
+ * end of each transaction, and on each transfer. The monitor is held by
+ * reference, so a single monitor can be shared by all interfaces on the same
+ * SPI bus to collect statistics for the entire bus. The underlying interface
+ * is also held by reference, so that interfaces which buffer the bytes of a
+ * transaction (e.g. HardSpiHwCsInterface) can be wrapped.
+ *
+ * The `T_MONITOR` class must implement the following methods:
+ *
+ *  * `void onBeginTransaction()`
+ *  * `void onTransfer(uint32_t numBytes)`
+ *  * `void onEndTransaction()`
+ *
+ * The monitor hooks are resolved at compile-time, so the overhead is limited to
+ * whatever work the monitor performs, usually a call to `micros()` and a few
+ * additions.
+ *
+ * @tparam T_SPII the underlying SPI interface (e.g. HardSpiInterface)
+ * @tparam T_MONITOR the class that receives the notifications (e.g.
+ *    BusUtilizationSampler)
+ */
+template <typename T_SPII, typename T_MONITOR>
+class InstrumentedSpiInterface {
+  public:
+    /** Same as the underlying interface. See isBufferedTransfer. */
+    static const bool kBufferedTransfer = isBufferedTransfer<T_SPII>::value;
+
+    /**
+     * Constructor.
+     *
+     * @param spiInterface the underlying SPI interface, stored by reference
+     * @param monitor the monitor object, stored by reference
+     */
+    explicit InstrumentedSpiInterface(
+        const T_SPII& spiInterface,
+        T_MONITOR& monitor
+    ) :
+        mSpiInterface(spiInterface),
+        mMonitor(monitor)
+    {}
+
+    /** Initialize the underlying interface. */
+    void begin() const {
+      mSpiInterface.begin();
+    }
+
+    /** Clean up the underlying interface. */
+    void end() const {
+      mSpiInterface.end();
+    }
+
+    /** Notify the monitor, then begin the SPI transaction. */
+    void beginTransaction() const {
+      mMonitor.onBeginTransaction();
+      mSpiInterface.beginTransaction();
+    }
+
+    /** End the SPI transaction, then notify the monitor. */
+    void endTransaction() const {
+      mSpiInterface.endTransaction();
+      mMonitor.onEndTransaction();
+    }
+
+    /** Transfer 8 bits. */
+    void transfer(uint8_t value) const {
+      mSpiInterface.transfer(value);
+      mMonitor.onTransfer(1);
+    }
+
+    /** Transfer 16 bits. */
+    void transfer16(uint16_t value) const {
+      mSpiInterface.transfer16(value);
+      mMonitor.onTransfer(2);
+    }
+
+    /** Transfer an array of 16-bit values, each in big-endian wire order. */
+    void transfer16Array(const uint16_t* values, uint16_t count) const {
+      mSpiInterface.transfer16Array(values, count);
+      mMonitor.onTransfer((uint32_t) count * 2);
+    }
+
+    /** Convenience method to send 8 bits a single transaction. */
+    void send8(uint8_t value) const {
+      beginTransaction();
+      transfer(value);
+      endTransaction();
+    }
+
+    /** Convenience method to send 16 bits a single transaction. */
+    void send16(uint16_t value) const {
+      beginTransaction();
+      transfer16(value);
+      endTransaction();
+    }
+
+    /** Convenience method to send 16 bits a single transaction. */
+    void send16(uint8_t msb, uint8_t lsb) const {
+      beginTransaction();
+      uint16_t value = ((uint16_t) msb) << 8 | (uint16_t) lsb;
+      transfer16(value);
+      endTransaction();
+    }
+
+    /**
+     * Convenience method to send a fixed sequence of bytes in a single
+     * transaction, e.g. `send(opcode, arg1, arg2)`. The arguments are expanded
+     * at compile-time into a straight sequence of transfer() calls, without
+     * copying them into a temporary array.
+     */
+    template <typename... T_ARGS>
+    void send(uint8_t value, T_ARGS... values) const {
+      static_assert(areByteArgs<T_ARGS...>::value,
+          "send() sends 1 byte per argument; cast wider values to uint8_t");
+      beginTransaction();
+      transferEach(value, values...);
+      endTransaction();
+    }
+
+    /**
+     * Forward each group of `pairsPerLatch` pairs to the sendRegisters() of
+     * the underlying interface, and report each group to the monitor as a
+     * separate transaction, matching the latch pulses on the bus. The
+     * underlying interface therefore applies its SPI settings once per group
+     * instead of once per array.
+     */
+    void sendRegisters(
+        const uint8_t* pairs,
+        uint8_t numPairs,
+        uint8_t pairsPerLatch = 1
+    ) const {
+      if (pairsPerLatch == 0) pairsPerLatch = 1;
+      while (numPairs > 0) {
+        uint8_t n = (numPairs < pairsPerLatch) ? numPairs : pairsPerLatch;
+        mMonitor.onBeginTransaction();
+        mSpiInterface.sendRegisters(pairs, n, n);
+        mMonitor.onTransfer((uint32_t) n * 2);
+        mMonitor.onEndTransaction();
+        pairs += (uint16_t) n * 2;
+        numPairs -= n;
+      }
+    }
+
+    /**
+     * Forward to the sendGenerated() of the underlying interface. The entire
+     * stream is reported to the monitor as a single transaction.
+     */
+    template <typename T_GENERATOR>
+    void sendGenerated(T_GENERATOR&& generator, uint16_t count) const {
+      mMonitor.onBeginTransaction();
+      mSpiInterface.sendGenerated(generator, count);
+      mMonitor.onTransfer(count);
+      mMonitor.onEndTransaction();
+    }
+
+    // Use default copy constructor. Delete the assignment operator which cannot
+    // be used with a reference member variable.
+    InstrumentedSpiInterface(const InstrumentedSpiInterface&) = default;
+    InstrumentedSpiInterface& operator=(const InstrumentedSpiInterface&) =
+        delete;
+
+  private:
+    /** Terminate the recursion of transferEach(). */
+    void transferEach() const {}
+
+    /** Transfer each argument in order. */
+    template <typename... T_ARGS>
+    void transferEach(uint8_t value, T_ARGS... values) const {
+      transfer(value);
+      transferEach(values...);
+    }
+
+    const T_SPII& mSpiInterface;
+    T_MONITOR& mMonitor;
+};
+
+} // ace_spi
+
+#endif
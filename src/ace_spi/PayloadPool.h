@@ -0,0 +1,189 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#ifndef ACE_SPI_PAYLOAD_POOL_H
+#define ACE_SPI_PAYLOAD_POOL_H
+
+#include <stdint.h>
+
+namespace ace_spi {
+
+/**
+ * A compile-time sized pool of fixed-size payload blocks for queuing SPI
+ * transfers without malloc(). Blocks are identified by a `uint8_t` handle.
+ * The free blocks are kept in a singly-linked free list, so acquire() and
+ * release() are O(1). Each block has a reference count, so that a single frame
+ * can be queued to several devices without copying it: the producer calls
+ * acquire() and fills the block, then retain() once for each additional
+ * consumer, and each consumer calls release() when it has sent the block.
+ *
+ * This class is not interrupt-safe. If blocks are released from an ISR, the
+ * calls from the main thread must be wrapped in `noInterrupts()` and
+ * `interrupts()`.
+ *
+ * @tparam T_BLOCK_SIZE size of each block in bytes (1-65535)
+ * @tparam T_NUM_BLOCKS number of blocks in the pool (1-254), because 255 is
+ *    reserved for kNoBlock
+ */
+template <uint16_t T_BLOCK_SIZE, uint8_t T_NUM_BLOCKS>
+class PayloadPool {
+  static_assert(T_BLOCK_SIZE > 0, "T_BLOCK_SIZE must be > 0");
+  static_assert(T_NUM_BLOCKS > 0 && T_NUM_BLOCKS < 255,
+      "T_NUM_BLOCKS must be between 1 and 254");
+
+  public:
+    /** Handle returned by acquire() when the pool is exhausted. */
+    static const uint8_t kNoBlock = 0xFF;
+
+    /** Constructor. All blocks are free. */
+    explicit PayloadPool() {
+      reset();
+    }
+
+    /** Mark all blocks as free, discarding all outstanding handles. */
+    void reset() {
+      for (uint8_t i = 0; i < T_NUM_BLOCKS; i++) {
+        mNext[i] = i + 1;
+        mRefCounts[i] = 0;
+        mLengths[i] = 0;
+      }
+      mNext[T_NUM_BLOCKS - 1] = kNoBlock;
+      mFreeHead = 0;
+      mFreeCount = T_NUM_BLOCKS;
+      mExhaustedCount = 0;
+    }
+
+    /**
+     * Acquire a free block with a reference count of 1 and a length of 0.
+     * Return kNoBlock if the pool is exhausted, and increment the counter
+     * returned by getExhaustedCount().
+     */
+    uint8_t acquire() {
+      uint8_t handle = mFreeHead;
+      if (handle == kNoBlock) {
+        mExhaustedCount++;
+        return kNoBlock;
+      }
+      mFreeHead = mNext[handle];
+      mFreeCount--;
+      mRefCounts[handle] = 1;
+      mLengths[handle] = 0;
+      return handle;
+    }
+
+    /**
+     * Add a reference to the block, for an additional consumer. Return false
+     * without changing the reference count if the handle is kNoBlock or a free
+     * block, or if the reference count is already 255.
+     */
+    bool retain(uint8_t handle) {
+      if (handle >= T_NUM_BLOCKS) return false;
+      uint8_t refCount = mRefCounts[handle];
+      if (refCount == 0 || refCount == 255) return false;
+      mRefCounts[handle] = refCount + 1;
+      return true;
+    }
+
+    /**
+     * Remove a reference to the block. The block is returned to the pool when
+     * its reference count reaches 0. Releasing kNoBlock or a free block does
+     * nothing.
+     */
+    void release(uint8_t handle) {
+      if (handle >= T_NUM_BLOCKS || mRefCounts[handle] == 0) return;
+      if (--mRefCounts[handle] > 0) return;
+      mNext[handle] = mFreeHead;
+      mFreeHead = handle;
+      mFreeCount++;
+    }
+
+    /** Return the pointer to the T_BLOCK_SIZE bytes of the block. */
+    uint8_t* getData(uint8_t handle) { return mData[handle]; }
+
+    /** Return the pointer to the T_BLOCK_SIZE bytes of the block. */
+    const uint8_t* getData(uint8_t handle) const { return mData[handle]; }
+
+    /** Set the number of valid bytes in the block, up to T_BLOCK_SIZE. */
+    void setLength(uint8_t handle, uint16_t length) {
+      mLengths[handle] = (length > T_BLOCK_SIZE) ? T_BLOCK_SIZE : length;
+    }
+
+    /** Return the number of valid bytes in the block. */
+    uint16_t getLength(uint8_t handle) const { return mLengths[handle]; }
+
+    /** Return the reference count of the block. */
+    uint8_t getRefCount(uint8_t handle) const { return mRefCounts[handle]; }
+
+    /** Return the number of free blocks. */
+    uint8_t getFreeCount() const { return mFreeCount; }
+
+    /** Return the number of acquire() calls which failed. */
+    uint16_t getExhaustedCount() const { return mExhaustedCount; }
+
+    /**
+     * Send the valid bytes of the block in a single transaction using the
+     * given SPI interface. The reference count is not changed.
+     */
+    template <typename T_SPII>
+    void send(const T_SPII& spiInterface, uint8_t handle) const {
+      const uint8_t* data = mData[handle];
+      uint16_t length = mLengths[handle];
+      spiInterface.beginTransaction();
+      for (uint16_t i = 0; i < length; i++) {
+        spiInterface.transfer(data[i]);
+      }
+      spiInterface.endTransaction();
+    }
+
+    /**
+     * Send the block using send(), then release() the reference held by this
+     * consumer.
+     */
+    template <typename T_SPII>
+    void sendAndRelease(const T_SPII& spiInterface, uint8_t handle) {
+      send(spiInterface, handle);
+      release(handle);
+    }
+
+  private:
+    // disable copy constructor and assignment operator
+    PayloadPool(const PayloadPool&) = delete;
+    PayloadPool& operator=(const PayloadPool&) = delete;
+
+    uint8_t mData[T_NUM_BLOCKS][T_BLOCK_SIZE];
+    uint16_t mLengths[T_NUM_BLOCKS];
+    uint8_t mRefCounts[T_NUM_BLOCKS];
+
+    /** Next free block of each free block, or kNoBlock. */
+    uint8_t mNext[T_NUM_BLOCKS];
+
+    uint8_t mFreeHead;
+    uint8_t mFreeCount;
+    uint16_t mExhaustedCount;
+};
+
+} // ace_spi
+
+#endif
@@ -0,0 +1,121 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#ifndef ACE_SPI_RGB565_CONVERTER_H
+#define ACE_SPI_RGB565_CONVERTER_H
+
+#include <stdint.h>
+
+namespace ace_spi {
+
+/**
+ * A streaming conversion stage which expands 8-bit palette indexes or RGB888
+ * pixels into RGB565 on the fly, and feeds them to one of the XxxInterface
+ * classes using transfer16Array(). The pixels are converted in chunks of
+ * T_CHUNK_SIZE into a small buffer on the stack, so the application never
+ * needs an RGB565 copy of the whole row or frame. The chunk size should match
+ * the FIFO or burst buffer of the underlying interface (e.g. 16 pixels for the
+ * 32-byte buffer of HardSpiInterface).
+ *
+ * The write methods do not begin or end a transaction, so that several calls
+ * can be combined into a single transaction, e.g. after sending the
+ * address-window commands of a TFT controller:
+ *
+ * @code{.cpp}
+ * spiInterface.beginTransaction();
+ * converter.writePalette(indexes, 128, palette);
+ * spiInterface.endTransaction();
+ * @endcode
+ *
+ * @tparam T_SPII the underlying SPI interface (e.g. HardSpiInterface)
+ * @tparam T_CHUNK_SIZE number of pixels converted per transfer16Array() call
+ */
+template <typename T_SPII, uint8_t T_CHUNK_SIZE = 16>
+class Rgb565Converter {
+  static_assert(T_CHUNK_SIZE > 0, "T_CHUNK_SIZE must be > 0");
+
+  public:
+    /**
+     * Constructor.
+     *
+     * @param spiInterface the underlying SPI interface, stored by reference
+     */
+    explicit Rgb565Converter(const T_SPII& spiInterface) :
+        mSpiInterface(spiInterface)
+    {}
+
+    /** Convert an 8-bit (red, green, blue) triple into RGB565. */
+    static uint16_t toRgb565(uint8_t red, uint8_t green, uint8_t blue) {
+      return ((uint16_t) (red & 0xF8) << 8)
+          | ((uint16_t) (green & 0xFC) << 3)
+          | (blue >> 3);
+    }
+
+    /**
+     * Send `count` pixels given as 8-bit indexes into a `palette` of RGB565
+     * colors. The palette must contain an entry for every index that is used,
+     * so a 16-color palette needs only 32 bytes of RAM.
+     */
+    void writePalette(
+        const uint8_t* indexes,
+        uint16_t count,
+        const uint16_t* palette
+    ) const {
+      uint16_t buffer[T_CHUNK_SIZE];
+      while (count > 0) {
+        uint8_t n = (count > T_CHUNK_SIZE) ? T_CHUNK_SIZE : count;
+        for (uint8_t i = 0; i < n; i++) {
+          buffer[i] = palette[indexes[i]];
+        }
+        mSpiInterface.transfer16Array(buffer, n);
+        indexes += n;
+        count -= n;
+      }
+    }
+
+    /**
+     * Send `count` pixels given as packed RGB888 triples
+     * `{r0, g0, b0, r1, g1, b1, ...}`, i.e. `3 * count` bytes.
+     */
+    void writeRgb888(const uint8_t* rgb, uint16_t count) const {
+      uint16_t buffer[T_CHUNK_SIZE];
+      while (count > 0) {
+        uint8_t n = (count > T_CHUNK_SIZE) ? T_CHUNK_SIZE : count;
+        for (uint8_t i = 0; i < n; i++) {
+          buffer[i] = toRgb565(rgb[0], rgb[1], rgb[2]);
+          rgb += 3;
+        }
+        mSpiInterface.transfer16Array(buffer, n);
+        count -= n;
+      }
+    }
+
+  private:
+    const T_SPII& mSpiInterface;
+};
+
+} // ace_spi
+
+#endif
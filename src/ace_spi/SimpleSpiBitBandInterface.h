@@ -0,0 +1,208 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#ifndef ACE_SPI_SIMPLE_SPI_BIT_BAND_INTERFACE_H
+#define ACE_SPI_SIMPLE_SPI_BIT_BAND_INTERFACE_H
+
+#include <stdint.h>
+#include "ByteArgs.h"
+
+namespace ace_spi {
+
+/**
+ * Software SPI using pin policy classes, normally BitBandPin on ARM Cortex-M3
+ * and M4 processors, where each pin is written with a single 32-bit store to
+ * its bit-band alias. The data bit is written without a branch.
+ *
+ * Each pin policy class must provide the following static methods:
+ * `setOutput()`, `setInput()`, `setHigh()`, `setLow()`, and `write(uint8_t)`.
+ *
+ * @tparam T_LATCH_PIN pin policy of the latch pin (CS)
+ * @tparam T_DATA_PIN pin policy of the data pin (MOSI)
+ * @tparam T_CLOCK_PIN pin policy of the clock pin (CLK)
+ */
+template <typename T_LATCH_PIN, typename T_DATA_PIN, typename T_CLOCK_PIN>
+class SimpleSpiBitBandInterface {
+  public:
+    /** Constructor. */
+    explicit SimpleSpiBitBandInterface() = default;
+
+    /** Initialize the various pins. */
+    void begin() const {
+      T_LATCH_PIN::setOutput();
+      T_DATA_PIN::setOutput();
+      T_CLOCK_PIN::setOutput();
+    }
+
+    /** Reset the various pins. */
+    void end() const {
+      T_LATCH_PIN::setInput();
+      T_DATA_PIN::setInput();
+      T_CLOCK_PIN::setInput();
+    }
+
+    /** Begin SPI transaction. Pull latch LOW. */
+    void beginTransaction() const {
+      T_LATCH_PIN::setLow();
+    }
+
+    /** End SPI transaction. Pull latch HIGH. */
+    void endTransaction() const {
+      T_LATCH_PIN::setHigh();
+    }
+
+    /** Transfer 8 bits. */
+    void transfer(uint8_t value) const {
+      shiftOutBitBand(value);
+    }
+
+    /** Transfer 16 bits. */
+    void transfer16(uint16_t value) const {
+      uint8_t msb = (value & 0xff00) >> 8;
+      uint8_t lsb = (value & 0xff);
+      shiftOutBitBand(msb);
+      shiftOutBitBand(lsb);
+    }
+
+    /**
+     * Transfer an array of 16-bit values (e.g. RGB565 pixels), each in
+     * big-endian wire order (MSB first).
+     */
+    void transfer16Array(const uint16_t* values, uint16_t count) const {
+      for (uint16_t i = 0; i < count; i++) {
+        transfer16(values[i]);
+      }
+    }
+
+    /** Convenience method to send 8 bits a single transaction. */
+    void send8(uint8_t value) const {
+      beginTransaction();
+      transfer(value);
+      endTransaction();
+    }
+
+    /** Convenience method to send 16 bits a single transaction. */
+    void send16(uint16_t value) const {
+      beginTransaction();
+      transfer16(value);
+      endTransaction();
+    }
+
+    /** Convenience method to send 16 bits a single transaction. */
+    void send16(uint8_t msb, uint8_t lsb) const {
+      beginTransaction();
+      shiftOutBitBand(msb);
+      shiftOutBitBand(lsb);
+      endTransaction();
+    }
+
+    /**
+     * Convenience method to send a fixed sequence of bytes in a single
+     * transaction, e.g. `send(opcode, arg1, arg2)`. The arguments are expanded
+     * at compile-time into a straight sequence of transfer() calls, without
+     * copying them into a temporary array.
+     */
+    template <typename... T_ARGS>
+    void send(uint8_t value, T_ARGS... values) const {
+      static_assert(areByteArgs<T_ARGS...>::value,
+          "send() sends 1 byte per argument; cast wider values to uint8_t");
+      beginTransaction();
+      transferEach(value, values...);
+      endTransaction();
+    }
+
+    /**
+     * Send an array of (register, value) pairs, e.g. to initialize or refresh
+     * a MAX7219. The latch is pulsed after every `pairsPerLatch` pairs, which
+     * is the minimum allowed by devices that latch a 16-bit register write on
+     * the rising edge of CS/SS.
+     *
+     * @param pairs array of `2 * numPairs` bytes: {reg0, value0, reg1,
+     *    value1, ...}
+     * @param numPairs number of (register, value) pairs
+     * @param pairsPerLatch number of pairs shifted out between latch pulses,
+     *    default 1
+     */
+    void sendRegisters(
+        const uint8_t* pairs,
+        uint8_t numPairs,
+        uint8_t pairsPerLatch = 1
+    ) const {
+      if (pairsPerLatch == 0) pairsPerLatch = 1;
+      for (uint8_t i = 0; i < numPairs; ) {
+        beginTransaction();
+        for (uint8_t j = 0; j < pairsPerLatch && i < numPairs; j++, i++) {
+          shiftOutBitBand(pairs[0]);
+          shiftOutBitBand(pairs[1]);
+          pairs += 2;
+        }
+        endTransaction();
+      }
+    }
+
+    /**
+     * Send `count` bytes returned by successive calls to `generator()` in a
+     * single transaction, without an intermediate array. The generator is any
+     * function object (e.g. a lambda) whose `operator()` returns the next
+     * byte, and is usually inlined by the compiler.
+     */
+    template <typename T_GENERATOR>
+    void sendGenerated(T_GENERATOR&& generator, uint16_t count) const {
+      beginTransaction();
+      for (uint16_t i = 0; i < count; i++) {
+        transfer(generator());
+      }
+      endTransaction();
+    }
+
+    // Use default copy constructor and assignment operator.
+    SimpleSpiBitBandInterface(const SimpleSpiBitBandInterface&) = default;
+    SimpleSpiBitBandInterface& operator=(const SimpleSpiBitBandInterface&)
+        = default;
+
+  private:
+    /** Terminate the recursion of transferEach(). */
+    void transferEach() const {}
+
+    /** Transfer each argument in order. */
+    template <typename... T_ARGS>
+    void transferEach(uint8_t value, T_ARGS... values) const {
+      transfer(value);
+      transferEach(values...);
+    }
+
+    static void shiftOutBitBand(uint8_t output) {
+      for (uint8_t i = 0; i < 8; i++)  {
+        T_CLOCK_PIN::setLow();
+        T_DATA_PIN::write(output >> 7); // MSB first
+        T_CLOCK_PIN::setHigh();
+        output <<= 1;
+      }
+    }
+};
+
+} // ace_spi
+
+#endif
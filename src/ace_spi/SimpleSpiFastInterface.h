@@ -27,6 +27,7 @@ SOFTWARE.
 
 #include <stdint.h>
 #include <Arduino.h> // OUTPUT, INPUT
+#include "ByteArgs.h"
 
 namespace ace_spi {
 
@@ -81,6 +82,16 @@ class SimpleSpiFastInterface {
       shiftOutFast(lsb);
     }
 
+    /**
+     * Transfer an array of 16-bit values (e.g. RGB565 pixels), each in
+     * big-endian wire order (MSB first).
+     */
+    void transfer16Array(const uint16_t* values, uint16_t count) const {
+      for (uint16_t i = 0; i < count; i++) {
+        transfer16(values[i]);
+      }
+    }
+
     /** Convenience method to send 8 bits a single transaction. */
     void send8(uint8_t value) const {
       beginTransaction();
@@ -103,11 +114,82 @@ class SimpleSpiFastInterface {
       endTransaction();
     }
 
+    /**
+     * Convenience method to send a fixed sequence of bytes in a single
+     * transaction, e.g. `send(opcode, arg1, arg2)`. The arguments are expanded
+     * at compile-time into a straight sequence of transfer() calls, without
+     * copying them into a temporary array.
+     */
+    template <typename... T_ARGS>
+    void send(uint8_t value, T_ARGS... values) const {
+      static_assert(areByteArgs<T_ARGS...>::value,
+          "send() sends 1 byte per argument; cast wider values to uint8_t");
+      beginTransaction();
+      transferEach(value, values...);
+      endTransaction();
+    }
+
+    /**
+     * Send an array of (register, value) pairs, e.g. to initialize or refresh
+     * a MAX7219. The latch is pulsed after every `pairsPerLatch` pairs, which
+     * is the minimum allowed by devices that latch a 16-bit register write on
+     * the rising edge of CS/SS. For a chain of N daisy-chained devices,
+     * `pairsPerLatch` should be N, and each group of N pairs should be ordered
+     * starting with the device furthest along the chain.
+     *
+     * @param pairs array of `2 * numPairs` bytes: {reg0, value0, reg1,
+     *    value1, ...}
+     * @param numPairs number of (register, value) pairs
+     * @param pairsPerLatch number of pairs shifted out between latch pulses,
+     *    default 1
+     */
+    void sendRegisters(
+        const uint8_t* pairs,
+        uint8_t numPairs,
+        uint8_t pairsPerLatch = 1
+    ) const {
+      if (pairsPerLatch == 0) pairsPerLatch = 1;
+      for (uint8_t i = 0; i < numPairs; ) {
+        beginTransaction();
+        for (uint8_t j = 0; j < pairsPerLatch && i < numPairs; j++, i++) {
+          shiftOutFast(pairs[0]);
+          shiftOutFast(pairs[1]);
+          pairs += 2;
+        }
+        endTransaction();
+      }
+    }
+
+    /**
+     * Send `count` bytes returned by successive calls to `generator()` in a
+     * single transaction, without an intermediate array. The generator is any
+     * function object (e.g. a lambda) whose `operator()` returns the next
+     * byte, and is usually inlined by the compiler.
+     */
+    template <typename T_GENERATOR>
+    void sendGenerated(T_GENERATOR&& generator, uint16_t count) const {
+      beginTransaction();
+      for (uint16_t i = 0; i < count; i++) {
+        transfer(generator());
+      }
+      endTransaction();
+    }
+
     // Use default copy constructor and assignment operator.
     SimpleSpiFastInterface(const SimpleSpiFastInterface&) = default;
     SimpleSpiFastInterface& operator=(const SimpleSpiFastInterface&) = default;
 
   private:
+    /** Terminate the recursion of transferEach(). */
+    void transferEach() const {}
+
+    /** Transfer each argument in order. */
+    template <typename... T_ARGS>
+    void transferEach(uint8_t value, T_ARGS... values) const {
+      transfer(value);
+      transferEach(values...);
+    }
+
     static void shiftOutFast(uint8_t output) {
       uint8_t mask = 0x80; // start with the MSB
       for (uint8_t i = 0; i < 8; i++)  {
@@ -0,0 +1,263 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#ifndef ACE_SPI_SIMPLE_SPI_WORD_INTERFACE_H
+#define ACE_SPI_SIMPLE_SPI_WORD_INTERFACE_H
+
+#include <stdint.h>
+#include "ByteArgs.h"
+
+namespace ace_spi {
+
+/**
+ * Software SPI for 32-bit processors (e.g. ESP32, STM32, Teensy) which shifts
+ * out up to 32 bits per invocation of its bit-bang loop, instead of one byte
+ * at a time. The bits are left-aligned in a single 32-bit register which is
+ * shifted left after each clock pulse, so the data bit is written without a
+ * mask or a branch. The 16-bit values, arrays, and generated bytes are packed
+ * into 32-bit words before entering the loop.
+ *
+ * Each pin policy class (e.g. BitBandPin, DigitalPin) must provide the
+ * following static methods: `setOutput()`, `setInput()`, `setHigh()`,
+ * `setLow()`, and `write(uint8_t)`.
+ *
+ * @tparam T_LATCH_PIN pin policy of the latch pin (CS)
+ * @tparam T_DATA_PIN pin policy of the data pin (MOSI)
+ * @tparam T_CLOCK_PIN pin policy of the clock pin (CLK)
+ */
+template <typename T_LATCH_PIN, typename T_DATA_PIN, typename T_CLOCK_PIN>
+class SimpleSpiWordInterface {
+  public:
+    /** Constructor. */
+    explicit SimpleSpiWordInterface() = default;
+
+    /** Initialize the various pins. */
+    void begin() const {
+      T_LATCH_PIN::setOutput();
+      T_DATA_PIN::setOutput();
+      T_CLOCK_PIN::setOutput();
+    }
+
+    /** Reset the various pins. */
+    void end() const {
+      T_LATCH_PIN::setInput();
+      T_DATA_PIN::setInput();
+      T_CLOCK_PIN::setInput();
+    }
+
+    /** Begin SPI transaction. Pull latch LOW. */
+    void beginTransaction() const {
+      T_LATCH_PIN::setLow();
+    }
+
+    /** End SPI transaction. Pull latch HIGH. */
+    void endTransaction() const {
+      T_LATCH_PIN::setHigh();
+    }
+
+    /** Transfer 8 bits. */
+    void transfer(uint8_t value) const {
+      shiftOutWord((uint32_t) value << 24, 8);
+    }
+
+    /** Transfer 16 bits. */
+    void transfer16(uint16_t value) const {
+      shiftOutWord((uint32_t) value << 16, 16);
+    }
+
+    /** Transfer 32 bits, MSB first. */
+    void transfer32(uint32_t value) const {
+      shiftOutWord(value, 32);
+    }
+
+    /**
+     * Transfer an array of 32-bit words, each MSB first. Each word is shifted
+     * out by a single invocation of the bit-bang loop.
+     */
+    void transferWords(const uint32_t* words, uint16_t count) const {
+      for (uint16_t i = 0; i < count; i++) {
+        shiftOutWord(words[i], 32);
+      }
+    }
+
+    /**
+     * Transfer an array of bytes in order. The bytes are packed 4 at a time
+     * into a 32-bit word, independent of the endianness of the processor.
+     */
+    void transferArray(const uint8_t* bytes, uint16_t count) const {
+      for (; count >= 4; count -= 4) {
+        shiftOutWord(
+            (uint32_t) bytes[0] << 24
+                | (uint32_t) bytes[1] << 16
+                | (uint32_t) bytes[2] << 8
+                | (uint32_t) bytes[3],
+            32);
+        bytes += 4;
+      }
+      uint32_t word = 0;
+      for (uint8_t i = 0; i < count; i++) {
+        word |= (uint32_t) bytes[i] << (24 - 8 * i);
+      }
+      shiftOutWord(word, count * 8);
+    }
+
+    /**
+     * Transfer an array of 16-bit values (e.g. RGB565 pixels), each in
+     * big-endian wire order (MSB first). Two values are packed into each
+     * 32-bit word.
+     */
+    void transfer16Array(const uint16_t* values, uint16_t count) const {
+      for (; count >= 2; count -= 2) {
+        shiftOutWord((uint32_t) values[0] << 16 | values[1], 32);
+        values += 2;
+      }
+      if (count) {
+        shiftOutWord((uint32_t) values[0] << 16, 16);
+      }
+    }
+
+    /** Convenience method to send 8 bits a single transaction. */
+    void send8(uint8_t value) const {
+      beginTransaction();
+      transfer(value);
+      endTransaction();
+    }
+
+    /** Convenience method to send 16 bits a single transaction. */
+    void send16(uint16_t value) const {
+      beginTransaction();
+      transfer16(value);
+      endTransaction();
+    }
+
+    /** Convenience method to send 16 bits a single transaction. */
+    void send16(uint8_t msb, uint8_t lsb) const {
+      beginTransaction();
+      shiftOutWord((uint32_t) msb << 24 | (uint32_t) lsb << 16, 16);
+      endTransaction();
+    }
+
+    /**
+     * Convenience method to send a fixed sequence of bytes in a single
+     * transaction, e.g. `send(opcode, arg1, arg2)`. The arguments are expanded
+     * at compile-time into a straight sequence of transfer() calls, without
+     * copying them into a temporary array.
+     */
+    template <typename... T_ARGS>
+    void send(uint8_t value, T_ARGS... values) const {
+      static_assert(areByteArgs<T_ARGS...>::value,
+          "send() sends 1 byte per argument; cast wider values to uint8_t");
+      beginTransaction();
+      transferEach(value, values...);
+      endTransaction();
+    }
+
+    /**
+     * Send an array of (register, value) pairs, e.g. to initialize or refresh
+     * a MAX7219. The latch is pulsed after every `pairsPerLatch` pairs, which
+     * is the minimum allowed by devices that latch a 16-bit register write on
+     * the rising edge of CS/SS. The pairs between latch pulses are shifted out
+     * as 32-bit words.
+     *
+     * @param pairs array of `2 * numPairs` bytes: {reg0, value0, reg1,
+     *    value1, ...}
+     * @param numPairs number of (register, value) pairs
+     * @param pairsPerLatch number of pairs shifted out between latch pulses,
+     *    default 1
+     */
+    void sendRegisters(
+        const uint8_t* pairs,
+        uint8_t numPairs,
+        uint8_t pairsPerLatch = 1
+    ) const {
+      if (pairsPerLatch == 0) pairsPerLatch = 1;
+      while (numPairs > 0) {
+        uint8_t n = (numPairs < pairsPerLatch) ? numPairs : pairsPerLatch;
+        beginTransaction();
+        transferArray(pairs, (uint16_t) n * 2);
+        endTransaction();
+        pairs += (uint16_t) n * 2;
+        numPairs -= n;
+      }
+    }
+
+    /**
+     * Send `count` bytes returned by successive calls to `generator()` in a
+     * single transaction, without an intermediate array. The generator is any
+     * function object (e.g. a lambda) whose `operator()` returns the next
+     * byte, and is usually inlined by the compiler. The bytes are collected
+     * into a 32-bit word, which is shifted out every 4 bytes.
+     */
+    template <typename T_GENERATOR>
+    void sendGenerated(T_GENERATOR&& generator, uint16_t count) const {
+      beginTransaction();
+      for (; count >= 4; count -= 4) {
+        uint32_t word = (uint32_t) generator() << 24;
+        word |= (uint32_t) generator() << 16;
+        word |= (uint32_t) generator() << 8;
+        word |= (uint32_t) generator();
+        shiftOutWord(word, 32);
+      }
+      uint32_t word = 0;
+      for (uint8_t i = 0; i < count; i++) {
+        word |= (uint32_t) generator() << (24 - 8 * i);
+      }
+      shiftOutWord(word, count * 8);
+      endTransaction();
+    }
+
+    // Use default copy constructor and assignment operator.
+    SimpleSpiWordInterface(const SimpleSpiWordInterface&) = default;
+    SimpleSpiWordInterface& operator=(const SimpleSpiWordInterface&)
+        = default;
+
+  private:
+    /** Terminate the recursion of transferEach(). */
+    void transferEach() const {}
+
+    /** Transfer each argument in order. */
+    template <typename... T_ARGS>
+    void transferEach(uint8_t value, T_ARGS... values) const {
+      transfer(value);
+      transferEach(values...);
+    }
+
+    /**
+     * Shift out the upper `numBits` bits of `word`, MSB first. This is the
+     * only bit-bang loop of this class.
+     */
+    static void shiftOutWord(uint32_t word, uint8_t numBits) {
+      for (; numBits > 0; numBits--) {
+        T_CLOCK_PIN::setLow();
+        T_DATA_PIN::write((uint8_t) (word >> 31));
+        T_CLOCK_PIN::setHigh();
+        word <<= 1;
+      }
+    }
+};
+
+} // ace_spi
+
+#endif
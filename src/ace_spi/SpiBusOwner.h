@@ -0,0 +1,114 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#ifndef ACE_SPI_SPI_BUS_OWNER_H
+#define ACE_SPI_SPI_BUS_OWNER_H
+
+#include <stdint.h>
+
+namespace ace_spi {
+
+/**
+ * Tracks which device currently holds an SPI bus selected, for interfaces
+ * which keep their device selected between transactions (e.g.
+ * HardSpiStickyInterface). A single instance is shared by all devices on the
+ * same bus. Each device is identified by its latch pin, so that copies of an
+ * interface object are treated as the same device.
+ *
+ * When a different device acquires the bus, the previous owner is released
+ * first through the release function that it registered. Code which uses the
+ * bus through a non-sticky interface (e.g. HardSpiInterface) must call
+ * release() before its transaction.
+ */
+class SpiBusOwner {
+  public:
+    /**
+     * Function which deselects the device on `latchPin` and ends the
+     * transaction on the bus identified by `context`.
+     */
+    typedef void (*ReleaseFunction)(void* context, uint8_t latchPin);
+
+    /** Value of the owner when no device holds the bus. */
+    static const uint8_t kNoOwner = 0xFF;
+
+    /** Constructor. */
+    explicit SpiBusOwner() = default;
+
+    /** Return true if the device on `latchPin` currently holds the bus. */
+    bool isOwner(uint8_t latchPin) const { return mOwner == latchPin; }
+
+    /** Return true if any device currently holds the bus. */
+    bool isOwned() const { return mOwner != kNoOwner; }
+
+    /**
+     * Make the device on `latchPin` the current owner of the bus, releasing
+     * the previous owner if it is a different device. Return true if the bus
+     * was already held by this device, in which case the caller does not need
+     * to select its device again.
+     */
+    bool acquire(
+        uint8_t latchPin,
+        ReleaseFunction releaseFunction,
+        void* context
+    ) {
+      if (mOwner == latchPin) return true;
+      release();
+      mOwner = latchPin;
+      mReleaseFunction = releaseFunction;
+      mContext = context;
+      return false;
+    }
+
+    /** Release the current owner of the bus, if any. */
+    void release() {
+      if (mOwner == kNoOwner) return;
+      uint8_t owner = mOwner;
+      mOwner = kNoOwner;
+      mReleaseFunction(mContext, owner);
+    }
+
+    /**
+     * Record an attempt to transfer data by a device which does not hold the
+     * bus. The data is not sent.
+     */
+    void recordViolation() { mViolationCount++; }
+
+    /** Number of transfers rejected because the device did not hold the bus. */
+    uint16_t getViolationCount() const { return mViolationCount; }
+
+  private:
+    // disable copy constructor and assignment operator
+    SpiBusOwner(const SpiBusOwner&) = delete;
+    SpiBusOwner& operator=(const SpiBusOwner&) = delete;
+
+    ReleaseFunction mReleaseFunction = nullptr;
+    void* mContext = nullptr;
+    uint16_t mViolationCount = 0;
+    uint8_t mOwner = kNoOwner;
+};
+
+} // ace_spi
+
+#endif
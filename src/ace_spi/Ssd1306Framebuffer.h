@@ -0,0 +1,252 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#ifndef ACE_SPI_SSD1306_FRAMEBUFFER_H
+#define ACE_SPI_SSD1306_FRAMEBUFFER_H
+
+#include <stdint.h>
+#include <string.h> // memset()
+#include "BufferedTransfer.h"
+
+namespace ace_spi {
+
+/**
+ * A monochrome framebuffer for SSD1306-class OLED controllers (SSD1306,
+ * SSD1309, SH1106) which tracks the range of modified columns on each page,
+ * and flushes only those ranges. The buffer uses the native layout of the
+ * controller: each page is a row of 8 pixels high, and each byte is one
+ * column of a page with the top pixel in bit 0.
+ *
+ * The flush() sends, for each dirty page, the 3 commands which select the page
+ * and the start column in the page addressing mode (the reset default of the
+ * controller), followed by the data bytes of the dirty columns. All pages are
+ * sent in a single transaction, toggling the D/C pin between the commands and
+ * the data. As with TftWindowWriter, the underlying interface must complete
+ * each transfer() before it returns, and the interfaces which buffer or
+ * pipeline the bytes are rejected at compile-time (see isBufferedTransfer).
+ *
+ * The SH1106 has 132 columns of RAM, and the 128 columns of most SH1106
+ * modules are wired to columns 2-129, so T_COLUMN_OFFSET must be 2 for those
+ * modules. It is 0 for the SSD1306 and SSD1309.
+ *
+ * @tparam T_SPII the underlying SPI interface (e.g. HardSpiInterface)
+ * @tparam T_DC_PIN pin policy of the D/C pin (e.g. DigitalPin, DigitalFastPin),
+ *    LOW for commands and HIGH for data
+ * @tparam T_WIDTH width of the display in pixels (1-128)
+ * @tparam T_HEIGHT height of the display in pixels, a multiple of 8
+ * @tparam T_COLUMN_OFFSET column address of the first visible column, default
+ *    0, 2 for most SH1106 modules
+ */
+template <
+    typename T_SPII,
+    typename T_DC_PIN,
+    uint8_t T_WIDTH = 128,
+    uint8_t T_HEIGHT = 64,
+    uint8_t T_COLUMN_OFFSET = 0
+>
+class Ssd1306Framebuffer {
+  static_assert(T_WIDTH > 0 && T_WIDTH <= 128, "T_WIDTH must be 1-128");
+  static_assert(T_HEIGHT > 0 && T_HEIGHT % 8 == 0,
+      "T_HEIGHT must be a multiple of 8");
+  static_assert(T_WIDTH + T_COLUMN_OFFSET <= 132,
+      "T_WIDTH + T_COLUMN_OFFSET must be <= 132");
+  static_assert(! isBufferedTransfer<T_SPII>::value,
+      "T_SPII must complete each transfer() before it returns");
+
+  public:
+    /** Number of pages, each 8 pixels high. */
+    static const uint8_t kNumPages = T_HEIGHT / 8;
+
+    /** Number of command bytes sent for each dirty page. */
+    static const uint8_t kPageCommandSize = 3;
+
+    /**
+     * Constructor.
+     *
+     * @param spiInterface the underlying SPI interface, stored by reference
+     */
+    explicit Ssd1306Framebuffer(const T_SPII& spiInterface) :
+        mSpiInterface(spiInterface)
+    {
+      clear();
+    }
+
+    /** Configure the D/C pin. Does not initialize the SPI interface. */
+    void begin() {
+      T_DC_PIN::setOutput();
+      T_DC_PIN::setHigh();
+    }
+
+    /** Release the D/C pin. */
+    void end() {
+      T_DC_PIN::setInput();
+    }
+
+    /** Clear all pixels, and mark the entire display as dirty. */
+    void clear() {
+      memset(mBuffer, 0, sizeof(mBuffer));
+      markAllDirty();
+    }
+
+    /** Set or clear the pixel at (x, y). Out of range pixels are ignored. */
+    void setPixel(uint8_t x, uint8_t y, bool on) {
+      if (x >= T_WIDTH || y >= T_HEIGHT) return;
+      uint8_t page = y >> 3;
+      uint8_t mask = 1 << (y & 0x07);
+      uint8_t column = on
+          ? (mBuffer[page][x] | mask)
+          : (mBuffer[page][x] & ~mask);
+      setColumn(page, x, column);
+    }
+
+    /** Return true if the pixel at (x, y) is set. */
+    bool getPixel(uint8_t x, uint8_t y) const {
+      if (x >= T_WIDTH || y >= T_HEIGHT) return false;
+      return mBuffer[y >> 3][x] & (1 << (y & 0x07));
+    }
+
+    /**
+     * Set the 8 vertical pixels of column `x` on `page`. The column is marked
+     * dirty only if its value changes.
+     */
+    void setColumn(uint8_t page, uint8_t x, uint8_t bits) {
+      if (page >= kNumPages || x >= T_WIDTH) return;
+      if (mBuffer[page][x] == bits) return;
+      mBuffer[page][x] = bits;
+      markDirty(page, x, x);
+    }
+
+    /** Return the 8 vertical pixels of column `x` on `page`. */
+    uint8_t getColumn(uint8_t page, uint8_t x) const {
+      return mBuffer[page][x];
+    }
+
+    /**
+     * Copy a page-aligned bitmap (e.g. an icon or a glyph of a font) in the
+     * native column format, `width` bytes for each of the `numPages` pages,
+     * with its top-left corner at column `x` of `page`. The bitmap is clipped
+     * to the display.
+     */
+    void drawBitmap(
+        uint8_t x,
+        uint8_t page,
+        uint8_t width,
+        uint8_t numPages,
+        const uint8_t* bitmap
+    ) {
+      for (uint8_t p = 0; p < numPages; p++) {
+        for (uint8_t i = 0; i < width; i++) {
+          setColumn(page + p, x + i, bitmap[p * width + i]);
+        }
+      }
+    }
+
+    /**
+     * Return the pointer to the raw buffer of `kNumPages` rows of `T_WIDTH`
+     * bytes. The caller must call markDirty() or markAllDirty() after writing
+     * directly into the buffer.
+     */
+    uint8_t* getBuffer() { return &mBuffer[0][0]; }
+
+    /** Mark the columns x0-x1 (inclusive) of `page` as dirty. */
+    void markDirty(uint8_t page, uint8_t x0, uint8_t x1) {
+      if (page >= kNumPages) return;
+      if (x1 >= T_WIDTH) x1 = T_WIDTH - 1;
+      if (x0 < mDirtyX0[page]) mDirtyX0[page] = x0;
+      if (x1 > mDirtyX1[page]) mDirtyX1[page] = x1;
+    }
+
+    /** Mark the entire display as dirty, e.g. after a reset of the display. */
+    void markAllDirty() {
+      for (uint8_t p = 0; p < kNumPages; p++) {
+        mDirtyX0[p] = 0;
+        mDirtyX1[p] = T_WIDTH - 1;
+      }
+    }
+
+    /** Return true if any page is dirty. */
+    bool isDirty() const {
+      for (uint8_t p = 0; p < kNumPages; p++) {
+        if (mDirtyX0[p] <= mDirtyX1[p]) return true;
+      }
+      return false;
+    }
+
+    /**
+     * Send the dirty columns of each page to the display in a single
+     * transaction, and mark them clean. Return the number of bytes sent,
+     * including the commands, or 0 if nothing was dirty.
+     */
+    uint16_t flush() {
+      if (! isDirty()) return 0;
+
+      uint16_t numBytes = 0;
+      mSpiInterface.beginTransaction();
+      for (uint8_t p = 0; p < kNumPages; p++) {
+        uint8_t x0 = mDirtyX0[p];
+        uint8_t x1 = mDirtyX1[p];
+        if (x0 > x1) continue;
+
+        uint8_t column = x0 + T_COLUMN_OFFSET;
+        T_DC_PIN::setLow();
+        mSpiInterface.transfer(0xB0 | p); // page start address
+        mSpiInterface.transfer(0x00 | (column & 0x0F)); // lower column
+        mSpiInterface.transfer(0x10 | (column >> 4)); // higher column
+        T_DC_PIN::setHigh();
+        const uint8_t* data = &mBuffer[p][x0];
+        for (uint8_t x = x0; x <= x1; x++) {
+          mSpiInterface.transfer(*data++);
+        }
+        numBytes += kPageCommandSize + (x1 - x0 + 1);
+
+        mDirtyX0[p] = kClean;
+        mDirtyX1[p] = 0;
+      }
+      mSpiInterface.endTransaction();
+      return numBytes;
+    }
+
+  private:
+    // disable copy constructor and assignment operator
+    Ssd1306Framebuffer(const Ssd1306Framebuffer&) = delete;
+    Ssd1306Framebuffer& operator=(const Ssd1306Framebuffer&) = delete;
+
+    /** Value of mDirtyX0[] of a clean page, larger than any mDirtyX1[]. */
+    static const uint8_t kClean = 0xFF;
+
+    const T_SPII& mSpiInterface;
+
+    uint8_t mBuffer[kNumPages][T_WIDTH];
+
+    /** First dirty column of each page, kClean if the page is clean. */
+    uint8_t mDirtyX0[kNumPages];
+
+    /** Last dirty column of each page. */
+    uint8_t mDirtyX1[kNumPages];
+};
+
+} // ace_spi
+
+#endif
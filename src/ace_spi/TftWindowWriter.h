@@ -0,0 +1,231 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#ifndef ACE_SPI_TFT_WINDOW_WRITER_H
+#define ACE_SPI_TFT_WINDOW_WRITER_H
+
+#include <stdint.h>
+#include "BufferedTransfer.h"
+
+namespace ace_spi {
+
+/**
+ * Writes rectangles of RGB565 pixels to a TFT controller with the MIPI DCS
+ * command set (e.g. ST7735, ST7789, ILI9341), using one of the XxxInterface
+ * classes and a pin policy for the data/command (D/C) pin. Each call to
+ * writePixels() sends the address window (CASET, RASET, RAMWR) and the pixels
+ * in a single transaction, toggling the D/C pin between the command and
+ * parameter bytes.
+ *
+ * The controller stays in the RAMWR mode until it receives the next command,
+ * and advances its write pointer through the window after each pixel. The
+ * writer tracks the same pointer, and skips the address window when the next
+ * rectangle starts at the pointer, i.e. when it continues the current row, or
+ * when it has the same columns and starts at the beginning of the next row.
+ * To make sequential rows contiguous, the window is always opened down to the
+ * last row of the display.
+ *
+ * The D/C pin must change only after the preceding byte has been shifted out,
+ * so the underlying interface must complete each transfer() before it
+ * returns. The interfaces which buffer or pipeline the bytes
+ * (HardSpiStm32Interface, HardSpiEsp32Interface, HardSpiHwCsInterface) are
+ * rejected at compile-time (see isBufferedTransfer).
+ *
+ * @tparam T_SPII the underlying SPI interface (e.g. HardSpiInterface)
+ * @tparam T_DC_PIN pin policy of the D/C pin (e.g. DigitalPin, DigitalFastPin,
+ *    BitBandPin), LOW for commands and HIGH for data
+ */
+template <typename T_SPII, typename T_DC_PIN>
+class TftWindowWriter {
+  static_assert(! isBufferedTransfer<T_SPII>::value,
+      "T_SPII must complete each transfer() before it returns");
+
+  public:
+    /** Column address set. */
+    static const uint8_t kCaset = 0x2A;
+
+    /** Row address set. */
+    static const uint8_t kRaset = 0x2B;
+
+    /** Memory write. */
+    static const uint8_t kRamwr = 0x2C;
+
+    /**
+     * Constructor.
+     *
+     * @param spiInterface the underlying SPI interface, stored by reference
+     * @param height number of rows of the display, in the current rotation
+     */
+    explicit TftWindowWriter(const T_SPII& spiInterface, uint16_t height) :
+        mSpiInterface(spiInterface),
+        mHeight(height)
+    {}
+
+    /** Configure the D/C pin. Does not initialize the SPI interface. */
+    void begin() {
+      T_DC_PIN::setOutput();
+      T_DC_PIN::setHigh();
+      invalidate();
+    }
+
+    /** Release the D/C pin. */
+    void end() const {
+      T_DC_PIN::setInput();
+    }
+
+    /**
+     * Forget the current window, so that the next writePixels() sends the
+     * address window. Must be called if a command is sent to the controller
+     * without using this object.
+     */
+    void invalidate() {
+      mValid = false;
+    }
+
+    /**
+     * Send a command and its parameter bytes in a single transaction, e.g.
+     * during the initialization sequence. Terminates the RAMWR mode, so the
+     * next writePixels() sends the address window.
+     */
+    void sendCommand(
+        uint8_t command,
+        const uint8_t* params = nullptr,
+        uint8_t numParams = 0
+    ) {
+      mSpiInterface.beginTransaction();
+      T_DC_PIN::setLow();
+      mSpiInterface.transfer(command);
+      T_DC_PIN::setHigh();
+      for (uint8_t i = 0; i < numParams; i++) {
+        mSpiInterface.transfer(params[i]);
+      }
+      mSpiInterface.endTransaction();
+      invalidate();
+    }
+
+    /**
+     * Write the `width` x `height` rectangle of RGB565 pixels at (x, y) in a
+     * single transaction. The pixels are in row-major order. The address
+     * window is sent only if the rectangle does not continue from the current
+     * write pointer of the controller.
+     */
+    void writePixels(
+        uint16_t x,
+        uint16_t y,
+        uint16_t width,
+        uint16_t height,
+        const uint16_t* pixels
+    ) {
+      if (width == 0 || height == 0) return;
+      uint16_t x1 = x + width - 1;
+      uint16_t y1 = y + height - 1;
+
+      mSpiInterface.beginTransaction();
+      if (! isContiguous(x, y, x1, y1)) {
+        sendWindow(x, y, x1);
+      }
+      uint32_t count = (uint32_t) width * height;
+      advance(count);
+      while (count > 0) {
+        uint16_t n = (count > 0x8000) ? 0x8000 : (uint16_t) count;
+        mSpiInterface.transfer16Array(pixels, n);
+        pixels += n;
+        count -= n;
+      }
+      mSpiInterface.endTransaction();
+    }
+
+    /** Return the number of times that the address window was sent. */
+    uint16_t getWindowCount() const { return mWindowCount; }
+
+    /** Reset the counter returned by getWindowCount(). */
+    void resetWindowCount() { mWindowCount = 0; }
+
+  private:
+    /**
+     * Return true if the rectangle (x0, y0) - (x1, y1) starts at the write
+     * pointer, and fits in the current window.
+     */
+    bool isContiguous(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1)
+        const {
+      if (! mValid || x0 != mCursorX || y0 != mCursorY) return false;
+      if (y1 == y0) return x1 <= mWindowX1;
+      return x0 == mWindowX0 && x1 == mWindowX1;
+    }
+
+    /** Send CASET, RASET and RAMWR for columns x0-x1, from row y0 down. */
+    void sendWindow(uint16_t x0, uint16_t y0, uint16_t x1) {
+      T_DC_PIN::setLow();
+      mSpiInterface.transfer(kCaset);
+      T_DC_PIN::setHigh();
+      mSpiInterface.transfer16(x0);
+      mSpiInterface.transfer16(x1);
+
+      T_DC_PIN::setLow();
+      mSpiInterface.transfer(kRaset);
+      T_DC_PIN::setHigh();
+      mSpiInterface.transfer16(y0);
+      mSpiInterface.transfer16(mHeight - 1);
+
+      T_DC_PIN::setLow();
+      mSpiInterface.transfer(kRamwr);
+      T_DC_PIN::setHigh();
+
+      mWindowX0 = x0;
+      mWindowX1 = x1;
+      mCursorX = x0;
+      mCursorY = y0;
+      mValid = true;
+      mWindowCount++;
+    }
+
+    /** Advance the write pointer by `count` pixels. */
+    void advance(uint32_t count) {
+      uint16_t windowWidth = mWindowX1 - mWindowX0 + 1;
+      uint32_t offset = (uint32_t) (mCursorX - mWindowX0) + count;
+      uint32_t row = (uint32_t) mCursorY + offset / windowWidth;
+      mCursorX = mWindowX0 + offset % windowWidth;
+      if (row >= mHeight) {
+        // The controller wraps around to the first row of the window.
+        mValid = false;
+      } else {
+        mCursorY = row;
+      }
+    }
+
+    const T_SPII& mSpiInterface;
+    uint16_t const mHeight;
+
+    uint16_t mWindowX0 = 0;
+    uint16_t mWindowX1 = 0;
+    uint16_t mCursorX = 0;
+    uint16_t mCursorY = 0;
+    uint16_t mWindowCount = 0;
+    bool mValid = false;
+};
+
+} // ace_spi
+
+#endif
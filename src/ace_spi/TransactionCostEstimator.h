@@ -0,0 +1,136 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#ifndef ACE_SPI_TRANSACTION_COST_ESTIMATOR_H
+#define ACE_SPI_TRANSACTION_COST_ESTIMATOR_H
+
+#include <stdint.h>
+#include <Arduino.h> // micros()
+
+namespace ace_spi {
+
+/**
+ * A monitor for InstrumentedSpiInterface which estimates the fixed overhead of
+ * a transaction (latch pin, SPISettings, function calls) and the incremental
+ * cost of each byte, by fitting a straight line through the duration and the
+ * number of bytes of each transaction:
+ *
+ *    micros = overheadMicros + numBytes * microsPerByte
+ *
+ * The ratio `overheadMicros / microsPerByte`, returned by getOverheadBytes(),
+ * is the number of bytes that could be sent in the time taken by the
+ * overhead of one transaction. This is the largest gap of unchanged bytes that
+ * should be resent rather than split into 2 transactions (see
+ * FrameDeltaEncoder).
+ *
+ * The fit requires transactions of at least 2 different sizes. The resolution
+ * of `micros()` is 4 microseconds on 16 MHz AVR processors, so the estimate
+ * improves with the number of transactions.
+ */
+class TransactionCostEstimator {
+  public:
+    /** Constructor. */
+    explicit TransactionCostEstimator() = default;
+
+    /** Discard all samples. */
+    void reset() {
+      mNumTransactions = 0;
+      mSumBytes = 0;
+      mSumMicros = 0;
+      mSumBytesSquared = 0;
+      mSumBytesMicros = 0;
+    }
+
+    /** Number of transactions sampled. */
+    uint32_t getNumTransactions() const { return mNumTransactions; }
+
+    /**
+     * Estimated fixed overhead of a transaction, in microseconds. Return 0 if
+     * the transactions do not have at least 2 different sizes.
+     */
+    uint32_t getOverheadMicros() const {
+      int64_t d = denominator();
+      if (d <= 0) return 0;
+      int64_t intercept = (mSumMicros * mSumBytesSquared
+          - mSumBytes * mSumBytesMicros) / d;
+      return (intercept < 0) ? 0 : (uint32_t) intercept;
+    }
+
+    /**
+     * Estimated overhead of a transaction, in units of the time taken to send
+     * one byte. Return 0 if it cannot be estimated.
+     */
+    uint16_t getOverheadBytes() const {
+      int64_t n = mNumTransactions;
+      // intercept / slope, with the common denominator canceled out.
+      int64_t num = mSumMicros * mSumBytesSquared - mSumBytes * mSumBytesMicros;
+      int64_t den = n * mSumBytesMicros - mSumBytes * mSumMicros;
+      if (denominator() <= 0 || den <= 0 || num <= 0) return 0;
+      int64_t bytes = num / den;
+      return (bytes > 0xFFFF) ? 0xFFFF : (uint16_t) bytes;
+    }
+
+    /** Called by InstrumentedSpiInterface::beginTransaction(). */
+    void onBeginTransaction() {
+      mStartMicros = micros();
+      mNumBytes = 0;
+    }
+
+    /** Called by InstrumentedSpiInterface::transfer() and transfer16(). */
+    void onTransfer(uint32_t numBytes) {
+      mNumBytes += numBytes;
+    }
+
+    /** Called by InstrumentedSpiInterface::endTransaction(). */
+    void onEndTransaction() {
+      int64_t elapsedMicros = (uint32_t) (micros() - mStartMicros);
+      int64_t numBytes = mNumBytes;
+      mNumTransactions++;
+      mSumBytes += numBytes;
+      mSumMicros += elapsedMicros;
+      mSumBytesSquared += numBytes * numBytes;
+      mSumBytesMicros += numBytes * elapsedMicros;
+    }
+
+  private:
+    /** Common denominator of the least squares fit. */
+    int64_t denominator() const {
+      return (int64_t) mNumTransactions * mSumBytesSquared
+          - mSumBytes * mSumBytes;
+    }
+
+    uint32_t mStartMicros = 0;
+    uint32_t mNumBytes = 0;
+
+    uint32_t mNumTransactions = 0;
+    int64_t mSumBytes = 0;
+    int64_t mSumMicros = 0;
+    int64_t mSumBytesSquared = 0;
+    int64_t mSumBytesMicros = 0;
+};
+
+} // ace_spi
+
+#endif
@@ -0,0 +1,252 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#ifndef ACE_SPI_USI_SPI_INTERFACE_H
+#define ACE_SPI_USI_SPI_INTERFACE_H
+
+#include <stdint.h>
+#include <Arduino.h>
+#include "ByteArgs.h"
+
+namespace ace_spi {
+
+#if defined(__AVR_ATtiny25__) \
+    || defined(__AVR_ATtiny45__) \
+    || defined(__AVR_ATtiny85__)
+
+/**
+ * Register access policy for the USI of the ATtiny25/45/85, for use with
+ * UsiSpiInterface. DO is PB1, USCK is PB2. On the ATTinyCore, the Arduino pin
+ * number of each PBn pin is `n`, so the latch pin is also a bit of PORTB.
+ */
+struct UsiRegisters {
+  static void setUsidr(uint8_t value) { USIDR = value; }
+  static void setUsicr(uint8_t value) { USICR = value; }
+
+  static void enableOutputs() { DDRB |= _BV(PB1) | _BV(PB2); }
+  static void disableOutputs() { DDRB &= ~(_BV(PB1) | _BV(PB2)); }
+
+  static void setLatchOutput(uint8_t bit) { DDRB |= _BV(bit); }
+  static void setLatchInput(uint8_t bit) { DDRB &= ~_BV(bit); }
+  static void setLatchLow(uint8_t bit) { PORTB &= ~_BV(bit); }
+  static void setLatchHigh(uint8_t bit) { PORTB |= _BV(bit); }
+};
+
+#endif
+
+/**
+ * SPI interface using the Universal Serial Interface (USI) of ATtiny
+ * processors in three-wire mode, with the classic unrolled sequence of 16
+ * writes to USICR per byte. Each write is a single `out` instruction, so a
+ * byte takes about 16 CPU cycles, and the SPI clock is half of the CPU clock.
+ * It uses only SPI MODE0 and MSBFIRST, like the other classes in this library.
+ *
+ * No `<SPI.h>` or `digitalWrite()` is used, so this class consumes far less
+ * flash memory than HardSpiInterface on the ATtiny85, whose SPI library is
+ * itself implemented using the USI.
+ *
+ * The registers are accessed through the `T_REGS` policy class, normally
+ * `UsiRegisters` on the ATtiny25/45/85. It must provide the following static
+ * methods: `setUsidr(uint8_t)`, `setUsicr(uint8_t)`, `enableOutputs()`,
+ * `disableOutputs()`, `setLatchOutput(uint8_t)`, `setLatchInput(uint8_t)`,
+ * `setLatchLow(uint8_t)`, and `setLatchHigh(uint8_t)`. A class which records
+ * the register writes can be substituted to verify the strobe sequence on a
+ * host machine.
+ *
+ * @tparam T_LATCH_PIN the latch pin (CS), which is the PORTB bit number on the
+ *    ATtiny85
+ * @tparam T_REGS the register access policy, usually UsiRegisters
+ */
+template <uint8_t T_LATCH_PIN, typename T_REGS>
+class UsiSpiInterface {
+  private:
+    // Bits of USICR. Defined here instead of using <avr/io.h> so that the
+    // strobe sequence can be compiled on a host machine.
+    static const uint8_t kUsiwm0 = 0x10; // three-wire mode
+    static const uint8_t kUsiclk = 0x02; // clock strobe of the shift register
+    static const uint8_t kUsitc = 0x01; // toggle USCK
+
+    /** Toggle USCK from LOW to HIGH. The slave samples DO. */
+    static const uint8_t kClockHigh = kUsiwm0 | kUsitc;
+
+    /** Toggle USCK from HIGH to LOW and shift out the next bit on DO. */
+    static const uint8_t kClockLow = kUsiwm0 | kUsitc | kUsiclk;
+
+  public:
+    /** Constructor. */
+    explicit UsiSpiInterface() = default;
+
+    /** Initialize the USI pins and the latch pin. */
+    void begin() const {
+      T_REGS::setLatchHigh(T_LATCH_PIN);
+      T_REGS::setLatchOutput(T_LATCH_PIN);
+      T_REGS::enableOutputs();
+    }
+
+    /** Reset the USI pins and the latch pin. */
+    void end() const {
+      T_REGS::setLatchInput(T_LATCH_PIN);
+      T_REGS::disableOutputs();
+    }
+
+    /** Begin SPI transaction. Pull latch LOW. */
+    void beginTransaction() const {
+      T_REGS::setLatchLow(T_LATCH_PIN);
+    }
+
+    /** End SPI transaction. Pull latch HIGH. */
+    void endTransaction() const {
+      T_REGS::setLatchHigh(T_LATCH_PIN);
+    }
+
+    /** Transfer 8 bits. */
+    void transfer(uint8_t value) const {
+      T_REGS::setUsidr(value);
+      T_REGS::setUsicr(kClockHigh); T_REGS::setUsicr(kClockLow);
+      T_REGS::setUsicr(kClockHigh); T_REGS::setUsicr(kClockLow);
+      T_REGS::setUsicr(kClockHigh); T_REGS::setUsicr(kClockLow);
+      T_REGS::setUsicr(kClockHigh); T_REGS::setUsicr(kClockLow);
+      T_REGS::setUsicr(kClockHigh); T_REGS::setUsicr(kClockLow);
+      T_REGS::setUsicr(kClockHigh); T_REGS::setUsicr(kClockLow);
+      T_REGS::setUsicr(kClockHigh); T_REGS::setUsicr(kClockLow);
+      T_REGS::setUsicr(kClockHigh); T_REGS::setUsicr(kClockLow);
+    }
+
+    /** Transfer 16 bits. */
+    void transfer16(uint16_t value) const {
+      transfer((uint8_t) (value >> 8));
+      transfer((uint8_t) value);
+    }
+
+    /**
+     * Transfer an array of 16-bit values (e.g. RGB565 pixels), each in
+     * big-endian wire order (MSB first).
+     */
+    void transfer16Array(const uint16_t* values, uint16_t count) const {
+      for (uint16_t i = 0; i < count; i++) {
+        transfer16(values[i]);
+      }
+    }
+
+    /** Convenience method to send 8 bits a single transaction. */
+    void send8(uint8_t value) const {
+      beginTransaction();
+      transfer(value);
+      endTransaction();
+    }
+
+    /** Convenience method to send 16 bits a single transaction. */
+    void send16(uint16_t value) const {
+      beginTransaction();
+      transfer16(value);
+      endTransaction();
+    }
+
+    /** Convenience method to send 16 bits a single transaction. */
+    void send16(uint8_t msb, uint8_t lsb) const {
+      beginTransaction();
+      transfer(msb);
+      transfer(lsb);
+      endTransaction();
+    }
+
+    /**
+     * Convenience method to send a fixed sequence of bytes in a single
+     * transaction, e.g. `send(opcode, arg1, arg2)`. The arguments are expanded
+     * at compile-time into a straight sequence of transfer() calls, without
+     * copying them into a temporary array.
+     */
+    template <typename... T_ARGS>
+    void send(uint8_t value, T_ARGS... values) const {
+      static_assert(areByteArgs<T_ARGS...>::value,
+          "send() sends 1 byte per argument; cast wider values to uint8_t");
+      beginTransaction();
+      transferEach(value, values...);
+      endTransaction();
+    }
+
+    /**
+     * Send an array of (register, value) pairs, e.g. to initialize or refresh
+     * a MAX7219. The latch is pulsed after every `pairsPerLatch` pairs, which
+     * is the minimum allowed by devices that latch a 16-bit register write on
+     * the rising edge of CS/SS.
+     *
+     * @param pairs array of `2 * numPairs` bytes: {reg0, value0, reg1,
+     *    value1, ...}
+     * @param numPairs number of (register, value) pairs
+     * @param pairsPerLatch number of pairs shifted out between latch pulses,
+     *    default 1
+     */
+    void sendRegisters(
+        const uint8_t* pairs,
+        uint8_t numPairs,
+        uint8_t pairsPerLatch = 1
+    ) const {
+      if (pairsPerLatch == 0) pairsPerLatch = 1;
+      for (uint8_t i = 0; i < numPairs; ) {
+        beginTransaction();
+        for (uint8_t j = 0; j < pairsPerLatch && i < numPairs; j++, i++) {
+          transfer(pairs[0]);
+          transfer(pairs[1]);
+          pairs += 2;
+        }
+        endTransaction();
+      }
+    }
+
+    /**
+     * Send `count` bytes returned by successive calls to `generator()` in a
+     * single transaction, without an intermediate array. The generator is any
+     * function object (e.g. a lambda) whose `operator()` returns the next
+     * byte, and is usually inlined by the compiler.
+     */
+    template <typename T_GENERATOR>
+    void sendGenerated(T_GENERATOR&& generator, uint16_t count) const {
+      beginTransaction();
+      for (uint16_t i = 0; i < count; i++) {
+        transfer(generator());
+      }
+      endTransaction();
+    }
+
+    // Use default copy constructor and assignment operator.
+    UsiSpiInterface(const UsiSpiInterface&) = default;
+    UsiSpiInterface& operator=(const UsiSpiInterface&) = default;
+
+  private:
+    /** Terminate the recursion of transferEach(). */
+    void transferEach() const {}
+
+    /** Transfer each argument in order. */
+    template <typename... T_ARGS>
+    void transferEach(uint8_t value, T_ARGS... values) const {
+      transfer(value);
+      transferEach(values...);
+    }
+};
+
+} // ace_spi
+
+#endif
@@ -0,0 +1,325 @@
+/*
+MIT License
+
+Copyright (c) 2021 Brian T. Park
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+*/
+
+
+#ifndef ACE_SPI_WS2812_SPI_ENCODER_H
+#define ACE_SPI_WS2812_SPI_ENCODER_H
+
+#include <stdint.h>
+#include <Arduino.h> // micros()
+
+namespace ace_spi {
+
+/**
+ * The SPI symbols of the WS2812 data bits, and the lookup table which expands
+ * a nibble of data into 4 symbols. Used by Ws2812SpiEncoder.
+ *
+ * @tparam T_BITS_PER_SYMBOL 3 (0 = 100, 1 = 110 at 2.4 MHz) or 4 (0 = 1000,
+ *    1 = 1110 at 3.2 MHz)
+ */
+template <uint8_t T_BITS_PER_SYMBOL>
+struct Ws2812Symbols {
+  static_assert(T_BITS_PER_SYMBOL == 3 || T_BITS_PER_SYMBOL == 4,
+      "T_BITS_PER_SYMBOL must be 3 or 4");
+
+  /** SPI symbol of a 0 bit. */
+  static constexpr uint8_t kZero = (T_BITS_PER_SYMBOL == 3) ? 0x4 : 0x8;
+
+  /** SPI symbol of a 1 bit. */
+  static constexpr uint8_t kOne = (T_BITS_PER_SYMBOL == 3) ? 0x6 : 0xE;
+
+  /** Return the symbol of the lowest bit of `bit`. */
+  static constexpr uint16_t symbol(uint8_t bit) {
+    return (bit & 0x01) ? kOne : kZero;
+  }
+
+  /** Return the 4 symbols of `nibble`, MSB first. */
+  static constexpr uint16_t expandNibble(uint8_t nibble) {
+    return (symbol(nibble >> 3) << (3 * T_BITS_PER_SYMBOL))
+        | (symbol(nibble >> 2) << (2 * T_BITS_PER_SYMBOL))
+        | (symbol(nibble >> 1) << T_BITS_PER_SYMBOL)
+        | symbol(nibble);
+  }
+
+  /** Symbols of each nibble, 12 or 16 bits each. */
+  static constexpr uint16_t kNibbleTable[16] = {
+    expandNibble(0), expandNibble(1), expandNibble(2), expandNibble(3),
+    expandNibble(4), expandNibble(5), expandNibble(6), expandNibble(7),
+    expandNibble(8), expandNibble(9), expandNibble(10), expandNibble(11),
+    expandNibble(12), expandNibble(13), expandNibble(14), expandNibble(15),
+  };
+};
+
+// Definitions of the static constants, required in C++11 if they are odr-used.
+template <uint8_t T_BITS_PER_SYMBOL>
+constexpr uint8_t Ws2812Symbols<T_BITS_PER_SYMBOL>::kZero;
+
+template <uint8_t T_BITS_PER_SYMBOL>
+constexpr uint8_t Ws2812Symbols<T_BITS_PER_SYMBOL>::kOne;
+
+template <uint8_t T_BITS_PER_SYMBOL>
+constexpr uint16_t Ws2812Symbols<T_BITS_PER_SYMBOL>::kNibbleTable[16];
+
+namespace internal {
+
+/**
+ * Return true if the AVR SPI peripheral can produce a clock within 5% below
+ * `speed`. Its clock is `fcpu` divided by a power of 2 from 2 to 128, and
+ * SPISettings selects the fastest one which does not exceed the requested
+ * speed.
+ */
+constexpr bool isAvrSpiClockReachable(
+    uint32_t fcpu, uint32_t speed, uint16_t divisor = 2) {
+  return (divisor > 128)
+      ? false
+      : (fcpu / divisor <= speed && fcpu / divisor >= speed - speed / 20)
+          || isAvrSpiClockReachable(fcpu, speed, divisor * 2);
+}
+
+} // internal
+
+/**
+ * Driver for a strip of WS2812 (NeoPixel) LEDs on the MOSI pin of a hardware
+ * SPI interface, clocked at 2.4 MHz (3 bits per symbol) or 3.2 MHz (4 bits
+ * per symbol). Each data bit is expanded into a 3-bit or 4-bit SPI symbol whose
+ * leading 1 bits form the HIGH pulse of the WS2812 bit, so each color byte
+ * becomes 3 or 4 SPI bytes.
+ *
+ * The expansion is performed a pair of color bytes at a time into a staging
+ * buffer of T_CHUNK_SIZE pairs on the stack, which is sent using
+ * transfer16Array() of the underlying interface, so the expanded bitstream of
+ * the whole strip is never stored in RAM. The underlying interface must be
+ * configured with a clock speed of `kClockSpeed`, e.g.
+ * `HardSpiInterface<SPIClass, 3200000>`. Since every symbol ends with a 0 bit,
+ * MOSI is LOW during the small gaps between bytes, which only lengthen the LOW
+ * part of a WS2812 bit.
+ *
+ * On AVR, each byte is expanded by looking up its 2 nibbles in a 16-entry
+ * table. On 32-bit processors, and on the host, the bits of the byte are
+ * spread into their symbols using a few shifts and masks on a 32-bit register
+ * (SIMD within a register), without any memory access.
+ *
+ * On AVR, the hardware SPI clock is F_CPU divided by a power of 2, so
+ * kClockSpeed is reachable only with some clock frequencies, e.g. 9.6 MHz for
+ * 2.4 MHz, or 12.8 MHz for 3.2 MHz. A 16 MHz AVR produces 2 MHz for both,
+ * which is too slow for the WS2812. A static_assert rejects an F_CPU for which
+ * no divisor produces a clock within 5% below kClockSpeed.
+ *
+ * @tparam T_SPII the underlying SPI interface (e.g. HardSpiInterface)
+ * @tparam T_BITS_PER_SYMBOL 3 or 4 (default)
+ * @tparam T_CHUNK_SIZE number of pairs of color bytes expanded per
+ *    transfer16Array() call
+ */
+template <
+    typename T_SPII,
+    uint8_t T_BITS_PER_SYMBOL = 4,
+    uint8_t T_CHUNK_SIZE = 6
+>
+class Ws2812SpiEncoder {
+  static_assert(T_CHUNK_SIZE > 0, "T_CHUNK_SIZE must be > 0");
+#if defined(ARDUINO_ARCH_AVR) && defined(F_CPU)
+  static_assert(
+      internal::isAvrSpiClockReachable(F_CPU, 800000UL * T_BITS_PER_SYMBOL),
+      "F_CPU / 2^n (n = 1-7) cannot produce the SPI clock of the WS2812");
+#endif
+
+  public:
+    using Symbols = Ws2812Symbols<T_BITS_PER_SYMBOL>;
+
+    /** SPI clock speed of the symbols, 800 kHz times the symbol length. */
+    static const uint32_t kClockSpeed = 800000UL * T_BITS_PER_SYMBOL;
+
+    /** Number of SPI bytes produced by each color byte. */
+    static const uint8_t kBytesPerColor = T_BITS_PER_SYMBOL;
+
+    /**
+     * Minimum LOW time (in microseconds) between 2 updates, which latches the
+     * colors. Newer WS2812B revisions require 280 microseconds.
+     */
+    static const uint16_t kResetMicros = 300;
+
+    /**
+     * Expand `value` into 8 symbols using the nibble table. The symbols are
+     * right-aligned in the returned 24 or 32 bits, MSB first.
+     */
+    static uint32_t expandTable(uint8_t value) {
+      return ((uint32_t) Symbols::kNibbleTable[value >> 4]
+              << (4 * T_BITS_PER_SYMBOL))
+          | Symbols::kNibbleTable[value & 0x0F];
+    }
+
+    /**
+     * Expand `value` into 8 symbols by spreading its bits in a 32-bit
+     * register. Returns the same value as expandTable().
+     */
+    static uint32_t expandSwar(uint8_t value) {
+      uint32_t x = value;
+      if (T_BITS_PER_SYMBOL == 4) {
+        // Move bit i to bit 4i, then fill in the fixed bits of each symbol.
+        x = (x | (x << 12)) & 0x000F000F;
+        x = (x | (x << 6)) & 0x03030303;
+        x = (x | (x << 3)) & 0x11111111;
+        return 0x88888888 | (x * 6);
+      } else {
+        // Move bit i to bit 3i, then fill in the fixed bits of each symbol.
+        x = (x | (x << 8)) & 0x0000F00F;
+        x = (x | (x << 4)) & 0x000C30C3;
+        x = (x | (x << 2)) & 0x00249249;
+        return 0x00924924 | (x << 1);
+      }
+    }
+
+    /**
+     * Expand `value` using expandTable() on AVR, where each 32-bit shift and
+     * mask takes several instructions, and expandSwar() on the other
+     * processors, where it avoids the memory accesses of the table. The
+     * `Ws2812SpiEncoder` rows of AutoBenchmark compare both methods.
+     */
+    static uint32_t expand(uint8_t value) {
+    #if defined(ARDUINO_ARCH_AVR)
+      return expandTable(value);
+    #else
+      return expandSwar(value);
+    #endif
+    }
+
+    /**
+     * Expand `count` color bytes into `count * kBytesPerColor` SPI bytes in
+     * `out`, e.g. for a DMA transfer. Returns the number of bytes written.
+     */
+    static uint16_t encodeBytes(
+        const uint8_t* bytes,
+        uint16_t count,
+        uint8_t* out
+    ) {
+      for (uint16_t i = 0; i < count; i++) {
+        uint32_t symbols = expand(bytes[i]);
+        if (T_BITS_PER_SYMBOL == 4) *out++ = symbols >> 24;
+        *out++ = symbols >> 16;
+        *out++ = symbols >> 8;
+        *out++ = symbols;
+      }
+      return count * kBytesPerColor;
+    }
+
+    /**
+     * Constructor.
+     *
+     * @param spiInterface the underlying SPI interface, stored by reference
+     */
+    explicit Ws2812SpiEncoder(const T_SPII& spiInterface) :
+        mSpiInterface(spiInterface)
+    {}
+
+    /**
+     * Send the `numLeds` pixels of `rgb`, stored as packed (red, green, blue)
+     * triples, in a single transaction, in the (green, red, blue) order of the
+     * WS2812. If the previous update ended less than kResetMicros ago, wait
+     * until the colors of the previous update are latched.
+     */
+    void show(const uint8_t* rgb, uint16_t numLeds) {
+      while (micros() - mEndMicros < kResetMicros) {}
+
+      uint16_t words[T_CHUNK_SIZE * T_BITS_PER_SYMBOL];
+      uint16_t numWords = 0;
+      uint16_t count = numLeds * 3; // number of color bytes
+      uint8_t phase = 0;
+
+      mSpiInterface.beginTransaction();
+      while (count >= 2) {
+        uint8_t a = nextColor(rgb, phase);
+        uint8_t b = nextColor(rgb, phase);
+        numWords += packPair(expand(a), expand(b), &words[numWords]);
+        if (numWords == T_CHUNK_SIZE * T_BITS_PER_SYMBOL) {
+          mSpiInterface.transfer16Array(words, numWords);
+          numWords = 0;
+        }
+        count -= 2;
+      }
+      mSpiInterface.transfer16Array(words, numWords);
+      if (count) {
+        // The last color byte of an odd number of LEDs.
+        uint32_t symbols = expand(nextColor(rgb, phase));
+        if (T_BITS_PER_SYMBOL == 4) {
+          mSpiInterface.transfer16(symbols >> 16);
+          mSpiInterface.transfer16(symbols);
+        } else {
+          mSpiInterface.transfer16(symbols >> 8);
+          mSpiInterface.transfer(symbols);
+        }
+      }
+      mSpiInterface.endTransaction();
+      mEndMicros = micros();
+    }
+
+  private:
+    // disable copy constructor and assignment operator
+    Ws2812SpiEncoder(const Ws2812SpiEncoder&) = delete;
+    Ws2812SpiEncoder& operator=(const Ws2812SpiEncoder&) = delete;
+
+    /**
+     * Return the next color byte in the (green, red, blue) order of the
+     * WS2812, and advance `rgb` after the blue byte of each pixel.
+     */
+    static uint8_t nextColor(const uint8_t*& rgb, uint8_t& phase) {
+      uint8_t value;
+      if (phase == 0) {
+        value = rgb[1];
+        phase = 1;
+      } else if (phase == 1) {
+        value = rgb[0];
+        phase = 2;
+      } else {
+        value = rgb[2];
+        rgb += 3;
+        phase = 0;
+      }
+      return value;
+    }
+
+    /**
+     * Pack the symbols of 2 color bytes into 16-bit words, MSB first. Returns
+     * the number of words written, which is T_BITS_PER_SYMBOL.
+     */
+    static uint8_t packPair(uint32_t a, uint32_t b, uint16_t* words) {
+      if (T_BITS_PER_SYMBOL == 4) {
+        words[0] = a >> 16;
+        words[1] = a;
+        words[2] = b >> 16;
+        words[3] = b;
+      } else {
+        words[0] = a >> 8;
+        words[1] = (a << 8) | (b >> 16);
+        words[2] = b;
+      }
+      return T_BITS_PER_SYMBOL;
+    }
+
+    const T_SPII& mSpiInterface;
+    uint32_t mEndMicros = 0;
+};
+
+} // ace_spi
+
+#endif
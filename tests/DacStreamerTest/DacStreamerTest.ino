@@ -0,0 +1,181 @@
+#line 2 "DacStreamerTest.ino"
+
+#include <AUnit.h>
+#include <AceSPI.h>
+
+using aunit::TestRunner;
+using namespace ace_spi;
+
+//-----------------------------------------------------------------------------
+
+/** Interface which records the frames sent by send16(). */
+class FakeSpiInterface {
+  public:
+    void reset() { mNumFrames = 0; }
+
+    void send16(uint16_t value) const {
+      mFrames[mNumFrames++] = value;
+    }
+
+    mutable uint16_t mFrames[32];
+    mutable uint8_t mNumFrames = 0;
+};
+
+/** LDAC pin policy which counts the pulses. */
+struct FakeLdacPin {
+  static void setOutput() {}
+  static void setInput() {}
+  static void setHigh() { if (! level) numPulses++; level = true; }
+  static void setLow() { level = false; }
+
+  static bool level;
+  static uint8_t numPulses;
+};
+
+bool FakeLdacPin::level = true;
+uint8_t FakeLdacPin::numPulses = 0;
+
+const uint32_t PERIOD_MICROS = 100;
+
+FakeSpiInterface spiInterface;
+
+using Streamer = DacStreamer<FakeSpiInterface, 4, FakeLdacPin>;
+Streamer streamer(spiInterface, PERIOD_MICROS);
+
+//-----------------------------------------------------------------------------
+
+test(DacStreamerTest, frames_are_sent_in_order) {
+  spiInterface.reset();
+  streamer.begin();
+
+  assertTrue(streamer.write(0x1001));
+  assertTrue(streamer.write(0x1002));
+  assertTrue(streamer.write(0x1003));
+  assertEqual(3, streamer.available());
+
+  streamer.onTick(1000);
+  streamer.onTick(1100);
+  assertTrue(streamer.write(0x1004));
+  streamer.onTick(1200);
+  streamer.onTick(1300);
+
+  assertEqual(4, spiInterface.mNumFrames);
+  assertEqual(0x1001, spiInterface.mFrames[0]);
+  assertEqual(0x1002, spiInterface.mFrames[1]);
+  assertEqual(0x1003, spiInterface.mFrames[2]);
+  assertEqual(0x1004, spiInterface.mFrames[3]);
+  assertEqual(0, streamer.available());
+  assertEqual(0, streamer.getUnderrunCount());
+}
+
+test(DacStreamerTest, write_to_full_buffer_fails) {
+  spiInterface.reset();
+  streamer.begin();
+
+  for (uint16_t i = 0; i < 4; i++) {
+    assertTrue(streamer.write(i));
+  }
+  assertEqual(0, streamer.getFreeCount());
+  assertFalse(streamer.write(4));
+
+  // One tick frees one slot, which wraps around the ring buffer.
+  streamer.onTick(0);
+  assertTrue(streamer.write(4));
+  for (uint8_t i = 0; i < 4; i++) {
+    streamer.onTick(100 * (i + 1));
+  }
+
+  assertEqual(5, spiInterface.mNumFrames);
+  for (uint8_t i = 0; i < 5; i++) {
+    assertEqual(i, spiInterface.mFrames[i]);
+  }
+}
+
+test(DacStreamerTest, underrun_is_counted) {
+  spiInterface.reset();
+  streamer.begin();
+
+  streamer.write(0x0ABC);
+  streamer.onTick(0);
+  streamer.onTick(100);
+  streamer.onTick(200);
+
+  assertEqual(1, spiInterface.mNumFrames);
+  assertEqual(2, streamer.getUnderrunCount());
+  assertEqual((uint32_t) 3, streamer.getTickCount());
+
+  // The streamer resumes with the next frame.
+  streamer.write(0x0DEF);
+  streamer.onTick(300);
+  assertEqual(2, spiInterface.mNumFrames);
+  assertEqual(0x0DEF, spiInterface.mFrames[1]);
+  assertEqual(2, streamer.getUnderrunCount());
+}
+
+test(DacStreamerTest, ldac_is_pulsed_on_each_tick) {
+  spiInterface.reset();
+  streamer.begin();
+  FakeLdacPin::numPulses = 0;
+
+  streamer.write(1);
+  streamer.onTick(0);
+  streamer.onTick(100); // underrun still pulses LDAC
+
+  assertEqual(2, FakeLdacPin::numPulses);
+  assertTrue(FakeLdacPin::level);
+}
+
+test(DacStreamerTest, jitter_stats) {
+  spiInterface.reset();
+  streamer.begin();
+
+  // Fewer than 2 ticks give no interval.
+  assertEqual((uint32_t) 0, streamer.getMaxJitterMicros());
+  streamer.onTick(1000);
+  assertEqual((uint32_t) 0, streamer.getMaxJitterMicros());
+  assertEqual(UINT32_MAX, streamer.getMinPeriodMicros());
+  assertEqual((uint32_t) 0, streamer.getMaxPeriodMicros());
+
+  // Intervals of 100, 93 (7 early), 112 (12 late), 100.
+  streamer.onTick(1100);
+  streamer.onTick(1193);
+  streamer.onTick(1305);
+  streamer.onTick(1405);
+  assertEqual((uint32_t) 93, streamer.getMinPeriodMicros());
+  assertEqual((uint32_t) 112, streamer.getMaxPeriodMicros());
+  assertEqual((uint32_t) 12, streamer.getMaxJitterMicros());
+
+  // An interval of 80 (20 early) is now the largest deviation.
+  streamer.onTick(1485);
+  assertEqual((uint32_t) 20, streamer.getMaxJitterMicros());
+
+  streamer.resetStats();
+  assertEqual((uint32_t) 0, streamer.getTickCount());
+  assertEqual((uint32_t) 0, streamer.getMaxJitterMicros());
+}
+
+test(DacStreamerTest, stats_across_micros_rollover) {
+  spiInterface.reset();
+  streamer.begin();
+
+  streamer.onTick(UINT32_MAX - 49);
+  streamer.onTick(50);
+  assertEqual((uint32_t) 100, streamer.getMinPeriodMicros());
+  assertEqual((uint32_t) 100, streamer.getMaxPeriodMicros());
+  assertEqual((uint32_t) 0, streamer.getMaxJitterMicros());
+}
+
+//-----------------------------------------------------------------------------
+
+void setup() {
+#if ! defined(EPOXY_DUINO)
+  delay(1000); // wait to prevent garbage on SERIAL_PORT_MONITOR
+#endif
+
+  SERIAL_PORT_MONITOR.begin(115200);
+  while (!SERIAL_PORT_MONITOR); // needed for Leonardo/Micro
+}
+
+void loop() {
+  TestRunner::run();
+}
@@ -0,0 +1,34 @@
+/*
+ * Checks the selection of FastestHardSpi on the ATtiny25/45/85, by forcing the
+ * platform macro and faking the USI registers before including the header.
+ * Each of these files is compiled as a separate translation unit, and none of
+ * the forced classes is used at runtime, so the checks are static_assert()s.
+ * Each file uses its own latch pin to keep the instantiations distinct.
+ */
+
+#if defined(EPOXY_DUINO)
+
+#include <Arduino.h>
+
+#define __AVR_ATtiny85__ 1
+#ifndef _BV
+  #define _BV(bit) (1 << (bit))
+#endif
+#define PB1 1
+#define PB2 2
+extern volatile uint8_t USIDR;
+extern volatile uint8_t USICR;
+extern volatile uint8_t DDRB;
+extern volatile uint8_t PORTB;
+
+#include <ace_spi/FastestHardSpi.h>
+#include "IsSameType.h"
+
+using namespace ace_spi;
+
+static_assert(
+    isSameType<
+        FastestHardSpi<3>::Base, UsiSpiInterface<3, UsiRegisters>>::value,
+    "FastestHardSpi must select UsiSpiInterface on the ATtiny25/45/85");
+
+#endif
@@ -0,0 +1,38 @@
+/*
+ * Checks the selection of FastestHardSpi and FastestSoftSpi on AVR without a
+ * <digitalWriteFast.h> library, by forcing the platform macro and faking the
+ * SPI registers before including the headers. See FastestSpiAttiny.cpp.
+ */
+
+#if defined(EPOXY_DUINO)
+
+#include <Arduino.h>
+#include <SPI.h>
+
+#define ARDUINO_ARCH_AVR 1
+#ifndef _BV
+  #define _BV(bit) (1 << (bit))
+#endif
+#define SPIF 7
+extern volatile uint8_t SPDR;
+extern volatile uint8_t SPSR;
+
+#include <ace_spi/FastestHardSpi.h>
+#include <ace_spi/FastestSoftSpi.h>
+#include "IsSameType.h"
+
+using namespace ace_spi;
+
+static_assert(
+    isSameType<
+        FastestHardSpi<4, 4000000>::Base,
+        HardSpiInterface<SPIClass, 4000000>>::value,
+    "FastestHardSpi must select HardSpiInterface on AVR without "
+    "digitalWriteFast");
+
+static_assert(
+    isSameType<FastestSoftSpi<4, 5, 6>::Base, SimpleSpiInterface>::value,
+    "FastestSoftSpi must select SimpleSpiInterface on AVR without "
+    "digitalWriteFast");
+
+#endif
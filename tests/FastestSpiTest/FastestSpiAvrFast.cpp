@@ -0,0 +1,41 @@
+/*
+ * Checks the selection of FastestHardSpi and FastestSoftSpi on AVR with a
+ * <digitalWriteFast.h> library included first, by forcing the platform macro,
+ * and faking the digitalWriteFast macros and the SPI registers before
+ * including the headers. See FastestSpiAttiny.cpp.
+ */
+
+#if defined(EPOXY_DUINO)
+
+#include <Arduino.h>
+#include <SPI.h>
+
+#define ARDUINO_ARCH_AVR 1
+#ifndef _BV
+  #define _BV(bit) (1 << (bit))
+#endif
+#define SPIF 7
+extern volatile uint8_t SPDR;
+extern volatile uint8_t SPSR;
+#define digitalWriteFast(pin, value) digitalWrite(pin, value)
+#define pinModeFast(pin, mode) pinMode(pin, mode)
+
+#include <ace_spi/FastestHardSpi.h>
+#include <ace_spi/FastestSoftSpi.h>
+#include "IsSameType.h"
+
+using namespace ace_spi;
+
+static_assert(
+    isSameType<
+        FastestHardSpi<7, 2000000>::Base,
+        HardSpiFastInterface<SPIClass, 7, 2000000>>::value,
+    "FastestHardSpi must select HardSpiFastInterface with digitalWriteFast");
+
+static_assert(
+    isSameType<
+        FastestSoftSpi<7, 8, 9>::Base,
+        SimpleSpiFastInterface<7, 8, 9>>::value,
+    "FastestSoftSpi must select SimpleSpiFastInterface with digitalWriteFast");
+
+#endif
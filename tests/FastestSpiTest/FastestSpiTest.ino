@@ -0,0 +1,62 @@
+#line 2 "FastestSpiTest.ino"
+
+#include <AUnit.h>
+#include <AceSPI.h>
+#include <ace_spi/FastestHardSpi.h>
+#include <ace_spi/FastestSoftSpi.h>
+#include "IsSameType.h"
+
+using aunit::TestRunner;
+using namespace ace_spi;
+
+// The selection on the ATtiny and on AVR, with and without digitalWriteFast,
+// is checked at compile-time in FastestSpiAttiny.cpp, FastestSpiAvr.cpp and
+// FastestSpiAvrFast.cpp. This file checks the generic platform, which is the
+// one under EpoxyDuino.
+
+//-----------------------------------------------------------------------------
+
+test(FastestSpiTest, hard_spi_generic) {
+  assertTrue((isSameType<
+      FastestHardSpi<10>::Base, HardSpiInterface<SPIClass>>::value));
+  assertTrue((isSameType<
+      FastestHardSpi<10, 4000000>::Base,
+      HardSpiInterface<SPIClass, 4000000>>::value));
+}
+
+test(FastestSpiTest, soft_spi_generic) {
+  assertTrue((isSameType<
+      FastestSoftSpi<10, 11, 13>::Base,
+      SimpleSpiWordInterface<DigitalPin<10>, DigitalPin<11>, DigitalPin<13>>
+  >::value));
+}
+
+test(FastestSpiTest, default_constructor) {
+  FastestHardSpi<10> hardSpi;
+  FastestSoftSpi<10, 11, 13> softSpi;
+
+  SPI.begin();
+  hardSpi.begin();
+  hardSpi.send8(0x42);
+  hardSpi.end();
+  SPI.end();
+
+  softSpi.begin();
+  softSpi.send16(0x1234);
+  softSpi.end();
+}
+
+//-----------------------------------------------------------------------------
+
+void setup() {
+#if ! defined(EPOXY_DUINO)
+  delay(1000); // wait to prevent garbage on SERIAL_PORT_MONITOR
+#endif
+
+  SERIAL_PORT_MONITOR.begin(115200);
+  while (!SERIAL_PORT_MONITOR); // needed for Leonardo/Micro
+}
+
+void loop() {
+  TestRunner::run();
+}
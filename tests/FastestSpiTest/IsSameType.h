@@ -0,0 +1,11 @@
+#ifndef FASTEST_SPI_TEST_IS_SAME_TYPE_H
+#define FASTEST_SPI_TEST_IS_SAME_TYPE_H
+
+/** Minimal std::is_same, which is not available on AVR. */
+template <typename T, typename U>
+struct isSameType { static const bool value = false; };
+
+template <typename T>
+struct isSameType<T, T> { static const bool value = true; };
+
+#endif
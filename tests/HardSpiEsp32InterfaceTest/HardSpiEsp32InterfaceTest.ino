@@ -0,0 +1,238 @@
+#line 2 "HardSpiEsp32InterfaceTest.ino"
+
+#include <AUnit.h>
+#include <AceSPI.h>
+
+using aunit::TestRunner;
+using namespace ace_spi;
+
+//-----------------------------------------------------------------------------
+// Emulation of the registers of an ESP32 SPI peripheral (spi_dev_t).
+//-----------------------------------------------------------------------------
+
+/**
+ * The `cmd.usr` bit. Writing 1 starts a user command, which the fake
+ * peripheral records and completes immediately, so that the busy-wait on
+ * `cmd.usr` ends at once.
+ */
+struct FakeUsrBit {
+  FakeUsrBit& operator=(uint32_t value);
+  operator uint32_t() const { return 0; }
+};
+
+/** A user command as seen by the slave device. */
+struct FakeCommand {
+  uint8_t numBytes;
+  bool csKeepActive;
+  bool dlenMismatch;
+};
+
+struct FakeSpiDev {
+  void reset() {
+    mosi_dlen.usr_mosi_dbitlen = 0;
+    miso_dlen.usr_miso_dbitlen = 0;
+    pin.cs_keep_active = 0;
+    for (uint8_t i = 0; i < 16; i++) data_buf[i] = 0;
+    numCommands = 0;
+    numBytes = 0;
+  }
+
+  struct { FakeUsrBit usr; } cmd;
+  struct { uint32_t usr_mosi_dbitlen; } mosi_dlen;
+  struct { uint32_t usr_miso_dbitlen; } miso_dlen;
+  struct { uint32_t cs_keep_active; } pin;
+  uint32_t data_buf[16];
+
+  FakeCommand commands[8];
+  uint8_t numCommands = 0;
+  uint8_t bytes[256];
+  uint16_t numBytes = 0;
+};
+
+FakeSpiDev fakeRegs;
+
+/**
+ * Record the command. The peripheral shifts out the bytes of each 32-bit word
+ * of data_buf[] in little-endian order.
+ */
+FakeUsrBit& FakeUsrBit::operator=(uint32_t value) {
+  if (value) {
+    uint16_t numBits = fakeRegs.mosi_dlen.usr_mosi_dbitlen + 1;
+    uint8_t numBytes = numBits / 8;
+    FakeCommand& command = fakeRegs.commands[fakeRegs.numCommands++];
+    command.numBytes = numBytes;
+    command.csKeepActive = fakeRegs.pin.cs_keep_active;
+    command.dlenMismatch = (fakeRegs.miso_dlen.usr_miso_dbitlen
+        != fakeRegs.mosi_dlen.usr_mosi_dbitlen);
+    for (uint8_t i = 0; i < numBytes; i++) {
+      fakeRegs.bytes[fakeRegs.numBytes++] =
+          (uint8_t) (fakeRegs.data_buf[i >> 2] >> ((i & 0x03) * 8));
+    }
+  }
+  return *this;
+}
+
+/** Stand-in for SPIClass, which is used only by begin() and end(). */
+class FakeSpi {
+  public:
+    void beginTransaction(SPISettings /*settings*/) { mNumBegins++; }
+    void endTransaction() { mNumEnds++; }
+    void setHwCs(bool use) { mHwCs = use; }
+
+    uint8_t mNumBegins = 0;
+    uint8_t mNumEnds = 0;
+    bool mHwCs = false;
+};
+
+const uint8_t LATCH_PIN = 10;
+
+FakeSpi fakeSpi;
+
+using SpiInterface = HardSpiEsp32Interface<FakeSpi, FakeSpiDev>;
+SpiInterface spiInterface(fakeSpi, &fakeRegs, LATCH_PIN);
+
+using HwCsSpiInterface = HardSpiEsp32Interface<
+    FakeSpi, FakeSpiDev, 8000000, true /*T_HARDWARE_CS*/>;
+HwCsSpiInterface hwCsSpiInterface(fakeSpi, &fakeRegs, LATCH_PIN);
+
+//-----------------------------------------------------------------------------
+
+test(HardSpiEsp32InterfaceTest, begin_end) {
+  fakeSpi.mNumBegins = 0;
+  fakeSpi.mNumEnds = 0;
+
+  spiInterface.begin();
+  spiInterface.send8(0x11);
+  spiInterface.send8(0x22);
+  spiInterface.end();
+
+  // The SPIClass transaction is held open from begin() to end().
+  assertEqual(1, fakeSpi.mNumBegins);
+  assertEqual(1, fakeSpi.mNumEnds);
+}
+
+test(HardSpiEsp32InterfaceTest, little_endian_packing) {
+  spiInterface.begin();
+  fakeRegs.reset();
+  spiInterface.send(0x01, 0x02, 0x03, 0x04, 0x05, 0x06);
+  spiInterface.end();
+
+  assertEqual((uint32_t) 0x04030201, fakeRegs.data_buf[0]);
+  assertEqual((uint32_t) 0x00000605, fakeRegs.data_buf[1]);
+  assertEqual(1, fakeRegs.numCommands);
+  assertEqual(6, fakeRegs.commands[0].numBytes);
+  assertEqual((uint32_t) 47, fakeRegs.mosi_dlen.usr_mosi_dbitlen);
+  assertFalse(fakeRegs.commands[0].dlenMismatch);
+}
+
+test(HardSpiEsp32InterfaceTest, transfer16_is_msb_first) {
+  spiInterface.begin();
+  fakeRegs.reset();
+  spiInterface.send16(0x1234);
+  spiInterface.end();
+
+  assertEqual(1, fakeRegs.numCommands);
+  assertEqual(2, fakeRegs.numBytes);
+  assertEqual(0x12, fakeRegs.bytes[0]);
+  assertEqual(0x34, fakeRegs.bytes[1]);
+}
+
+test(HardSpiEsp32InterfaceTest, flush_at_64_bytes_and_endTransaction) {
+  spiInterface.begin();
+
+  // Exactly 64 bytes is a single command, sent by endTransaction().
+  fakeRegs.reset();
+  uint8_t i = 0;
+  spiInterface.sendGenerated([&i]() { return i++; }, 64);
+  assertEqual(1, fakeRegs.numCommands);
+  assertEqual(64, fakeRegs.commands[0].numBytes);
+
+  // 150 bytes are sent as 64 + 64 + 22 bytes, in order.
+  fakeRegs.reset();
+  i = 0;
+  spiInterface.sendGenerated([&i]() { return i++; }, 150);
+  spiInterface.end();
+
+  assertEqual(3, fakeRegs.numCommands);
+  assertEqual(64, fakeRegs.commands[0].numBytes);
+  assertEqual(64, fakeRegs.commands[1].numBytes);
+  assertEqual(22, fakeRegs.commands[2].numBytes);
+  assertEqual(150, fakeRegs.numBytes);
+  for (uint8_t j = 0; j < 150; j++) {
+    assertEqual(j, fakeRegs.bytes[j]);
+  }
+  for (uint8_t j = 0; j < 3; j++) {
+    assertFalse(fakeRegs.commands[j].csKeepActive);
+    assertFalse(fakeRegs.commands[j].dlenMismatch);
+  }
+}
+
+test(HardSpiEsp32InterfaceTest, sendRegisters) {
+  spiInterface.begin();
+  fakeRegs.reset();
+  const uint8_t pairs[] = {0x01, 0x11, 0x02, 0x22, 0x03, 0x33};
+  spiInterface.sendRegisters(pairs, 3, 2);
+  spiInterface.end();
+
+  assertEqual(2, fakeRegs.numCommands);
+  assertEqual(4, fakeRegs.commands[0].numBytes);
+  assertEqual(2, fakeRegs.commands[1].numBytes);
+  for (uint8_t i = 0; i < 6; i++) {
+    assertEqual(pairs[i], fakeRegs.bytes[i]);
+  }
+}
+
+test(HardSpiEsp32InterfaceTest, hardware_cs_short_transaction) {
+  hwCsSpiInterface.begin();
+  assertTrue(fakeSpi.mHwCs);
+
+  fakeRegs.reset();
+  uint8_t i = 0;
+  hwCsSpiInterface.sendGenerated([&i]() { return i++; }, 64);
+
+  assertEqual(1, fakeRegs.numCommands);
+  assertFalse(fakeRegs.commands[0].csKeepActive);
+  assertEqual((uint32_t) 0, fakeRegs.pin.cs_keep_active);
+
+  hwCsSpiInterface.end();
+  assertFalse(fakeSpi.mHwCs);
+}
+
+test(HardSpiEsp32InterfaceTest, hardware_cs_long_transaction_keeps_cs) {
+  hwCsSpiInterface.begin();
+  fakeRegs.reset();
+  uint8_t i = 0;
+  hwCsSpiInterface.sendGenerated([&i]() { return i++; }, 150);
+
+  // CS/SS is held across all 3 commands, and released after the last one.
+  assertEqual(3, fakeRegs.numCommands);
+  for (uint8_t j = 0; j < 3; j++) {
+    assertTrue(fakeRegs.commands[j].csKeepActive);
+  }
+  assertEqual((uint32_t) 0, fakeRegs.pin.cs_keep_active);
+  for (uint8_t j = 0; j < 150; j++) {
+    assertEqual(j, fakeRegs.bytes[j]);
+  }
+
+  // The next short transaction is a normal single command.
+  fakeRegs.reset();
+  hwCsSpiInterface.send8(0x42);
+  assertEqual(1, fakeRegs.numCommands);
+  assertFalse(fakeRegs.commands[0].csKeepActive);
+  hwCsSpiInterface.end();
+}
+
+//-----------------------------------------------------------------------------
+
+void setup() {
+#if ! defined(EPOXY_DUINO)
+  delay(1000); // wait to prevent garbage on SERIAL_PORT_MONITOR
+#endif
+
+  SERIAL_PORT_MONITOR.begin(115200);
+  while (!SERIAL_PORT_MONITOR); // needed for Leonardo/Micro
+}
+
+void loop() {
+  TestRunner::run();
+}
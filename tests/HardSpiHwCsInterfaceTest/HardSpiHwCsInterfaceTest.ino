@@ -0,0 +1,207 @@
+#line 2 "HardSpiHwCsInterfaceTest.ino"
+
+#include <AUnit.h>
+#include <AceSPI.h>
+
+using aunit::TestRunner;
+using namespace ace_spi;
+
+//-----------------------------------------------------------------------------
+
+/**
+ * Stand-in for the ESP8266/ESP32 SPIClass which records each writeBytes()
+ * call as a separate peripheral command, i.e. a separate CS/SS assertion when
+ * the hardware controls CS/SS.
+ */
+class FakeSpi {
+  public:
+    void reset() {
+      mNumCommands = 0;
+      mNumBytes = 0;
+      mNumHwCsChanges = 0;
+      mNumLockedHwCsChanges = 0;
+    }
+
+    // On the ESP32, setHwCs() takes the bus mutex, which deadlocks inside a
+    // transaction.
+    void setHwCs(bool use) {
+      mHwCs = use;
+      mNumHwCsChanges++;
+      if (mInTransaction) mNumLockedHwCsChanges++;
+    }
+
+    void beginTransaction(SPISettings /*settings*/) { mInTransaction = true; }
+    void endTransaction() { mInTransaction = false; }
+
+    void writeBytes(const uint8_t* data, uint32_t size) {
+      mCommandSizes[mNumCommands++] = size;
+      for (uint32_t i = 0; i < size; i++) {
+        mBytes[mNumBytes++] = data[i];
+      }
+    }
+
+    uint8_t mCommandSizes[16];
+    uint8_t mNumCommands = 0;
+    uint8_t mBytes[512];
+    uint16_t mNumBytes = 0;
+    bool mHwCs = false;
+    uint8_t mNumHwCsChanges = 0;
+    uint8_t mNumLockedHwCsChanges = 0;
+    bool mInTransaction = false;
+};
+
+/** A monitor which does nothing. */
+class NullMonitor {
+  public:
+    void onBeginTransaction() {}
+    void onTransfer(uint32_t /*numBytes*/) {}
+    void onEndTransaction() {}
+};
+
+FakeSpi fakeSpi;
+NullMonitor monitor;
+
+using SpiInterface = HardSpiHwCsInterface<FakeSpi>;
+SpiInterface spiInterface(fakeSpi, 15);
+
+//-----------------------------------------------------------------------------
+
+test(HardSpiHwCsInterfaceTest, transaction_is_single_command) {
+  fakeSpi.reset();
+  spiInterface.beginTransaction();
+  for (uint8_t i = 0; i < 21; i++) {
+    spiInterface.transfer(i);
+  }
+  spiInterface.endTransaction();
+
+  assertEqual(1, fakeSpi.mNumCommands);
+  assertEqual(21, fakeSpi.mCommandSizes[0]);
+  for (uint8_t i = 0; i < 21; i++) {
+    assertEqual(i, fakeSpi.mBytes[i]);
+  }
+}
+
+test(HardSpiHwCsInterfaceTest, wrapper_shares_buffer) {
+  InstrumentedSpiInterface<SpiInterface, NullMonitor> instrumented(
+      spiInterface, monitor);
+
+  fakeSpi.reset();
+  instrumented.beginTransaction();
+  for (uint8_t i = 0; i < 21; i++) {
+    instrumented.transfer(i);
+  }
+  instrumented.endTransaction();
+
+  assertEqual(1, fakeSpi.mNumCommands);
+  assertEqual(21, fakeSpi.mCommandSizes[0]);
+}
+
+test(HardSpiHwCsInterfaceTest, long_transaction_uses_software_cs) {
+  spiInterface.begin();
+  fakeSpi.reset();
+  uint16_t overflowCount = spiInterface.getOverflowCount();
+
+  // A 64-byte transaction still fits in a single hardware CS command.
+  spiInterface.beginTransaction();
+  for (uint8_t i = 0; i < 64; i++) {
+    spiInterface.transfer(i);
+  }
+  spiInterface.endTransaction();
+  assertEqual(1, fakeSpi.mNumCommands);
+  assertEqual(64, fakeSpi.mCommandSizes[0]);
+  assertEqual(0, fakeSpi.mNumHwCsChanges);
+  assertEqual(overflowCount, spiInterface.getOverflowCount());
+
+  // A 100-byte transaction is sent in chunks, with CS/SS held by software.
+  fakeSpi.reset();
+  spiInterface.beginTransaction();
+  for (uint8_t i = 0; i < 100; i++) {
+    spiInterface.transfer(i);
+  }
+  assertFalse(fakeSpi.mHwCs);
+  spiInterface.endTransaction();
+
+  assertEqual(2, fakeSpi.mNumCommands);
+  assertEqual(64, fakeSpi.mCommandSizes[0]);
+  assertEqual(36, fakeSpi.mCommandSizes[1]);
+  assertEqual(100, fakeSpi.mNumBytes);
+  for (uint8_t i = 0; i < 100; i++) {
+    assertEqual(i, fakeSpi.mBytes[i]);
+  }
+  assertEqual(2, fakeSpi.mNumHwCsChanges);
+  assertEqual(0, fakeSpi.mNumLockedHwCsChanges);
+  assertTrue(fakeSpi.mHwCs);
+  assertFalse(fakeSpi.mInTransaction);
+  assertEqual(overflowCount + 1, spiInterface.getOverflowCount());
+
+  // The next short transaction uses hardware CS again.
+  fakeSpi.reset();
+  spiInterface.send8(0x42);
+  assertEqual(1, fakeSpi.mNumCommands);
+  assertEqual(0, fakeSpi.mNumHwCsChanges);
+  spiInterface.end();
+}
+
+test(HardSpiHwCsInterfaceTest, transfer16Array_long_row) {
+  uint16_t pixels[128];
+  for (uint16_t i = 0; i < 128; i++) {
+    pixels[i] = (i << 8) | (uint8_t) ~i;
+  }
+
+  spiInterface.begin();
+  fakeSpi.reset();
+  spiInterface.beginTransaction();
+  spiInterface.transfer16Array(pixels, 128);
+  spiInterface.endTransaction();
+
+  assertEqual(4, fakeSpi.mNumCommands);
+  assertEqual(256, fakeSpi.mNumBytes);
+  for (uint16_t i = 0; i < 128; i++) {
+    assertEqual((uint8_t) (pixels[i] >> 8), fakeSpi.mBytes[2 * i]);
+    assertEqual((uint8_t) pixels[i], fakeSpi.mBytes[2 * i + 1]);
+  }
+  spiInterface.end();
+}
+
+test(HardSpiHwCsInterfaceTest, sendRegisters) {
+  fakeSpi.reset();
+  const uint8_t pairs[] = {0x01, 0x11, 0x02, 0x22, 0x03, 0x33};
+  spiInterface.sendRegisters(pairs, 3, 2);
+
+  assertEqual(2, fakeSpi.mNumCommands);
+  assertEqual(4, fakeSpi.mCommandSizes[0]);
+  assertEqual(2, fakeSpi.mCommandSizes[1]);
+  for (uint8_t i = 0; i < 6; i++) {
+    assertEqual(pairs[i], fakeSpi.mBytes[i]);
+  }
+}
+
+test(HardSpiHwCsInterfaceTest, sendRegisters_large_group_uses_software_cs) {
+  fakeSpi.reset();
+  uint16_t overflowCount = spiInterface.getOverflowCount();
+  uint8_t pairs[2 * 33] = {};
+  spiInterface.sendRegisters(pairs, 33, 33);
+
+  assertEqual(2, fakeSpi.mNumCommands);
+  assertEqual(64, fakeSpi.mCommandSizes[0]);
+  assertEqual(2, fakeSpi.mCommandSizes[1]);
+  assertEqual(overflowCount + 1, spiInterface.getOverflowCount());
+  assertEqual(0, fakeSpi.mNumLockedHwCsChanges);
+  assertTrue(fakeSpi.mHwCs);
+  assertFalse(fakeSpi.mInTransaction);
+}
+
+//-----------------------------------------------------------------------------
+
+void setup() {
+#if ! defined(EPOXY_DUINO)
+  delay(1000); // wait to prevent garbage on SERIAL_PORT_MONITOR
+#endif
+
+  SERIAL_PORT_MONITOR.begin(115200);
+  while (!SERIAL_PORT_MONITOR); // needed for Leonardo/Micro
+}
+
+void loop() {
+  TestRunner::run();
+}
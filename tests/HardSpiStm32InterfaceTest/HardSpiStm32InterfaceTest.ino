@@ -0,0 +1,172 @@
+#line 2 "HardSpiStm32InterfaceTest.ino"
+
+// Enable the 16-bit (DFF) path of transfer16Array(), as on the STM32F1/F4.
+#define SPI_CR1_DFF 0x0800
+
+#include <AUnit.h>
+#include <AceSPI.h>
+
+using aunit::TestRunner;
+using namespace ace_spi;
+
+//-----------------------------------------------------------------------------
+// Emulation of the CR1, SR, and DR registers of an STM32 SPI peripheral.
+//-----------------------------------------------------------------------------
+
+/** Value of DR when nothing has been written since the last read of SR. */
+const uint32_t kDrEmpty = 0xA5A5A5A5;
+
+struct FakeSpiRegs;
+
+/**
+ * The SR register. Each read records the frame written into DR since the
+ * previous read, which HardSpiStm32Interface always does before the next write
+ * (TXE poll) or the end of the transaction (BSY poll). TXE is always set and
+ * BSY is always clear. An 8-bit write of 0xA5 cannot be detected, so the test
+ * data must avoid that byte.
+ */
+struct FakeStatusRegister {
+  operator uint32_t() const;
+
+  FakeSpiRegs* regs;
+};
+
+struct FakeSpiRegs {
+  void reset() {
+    CR1 = 0;
+    DR = kDrEmpty;
+    numFrames = 0;
+  }
+
+  uint32_t CR1 = 0;
+  FakeStatusRegister SR{this};
+  uint32_t DR = kDrEmpty;
+
+  /** Frames written to DR, and whether each one was a 16-bit (DFF) frame. */
+  uint16_t frames[32];
+  bool wideFrames[32];
+  uint8_t numFrames = 0;
+};
+
+FakeStatusRegister::operator uint32_t() const {
+  if (regs->DR != kDrEmpty) {
+    bool wide = (regs->CR1 & SPI_CR1_DFF) != 0;
+    regs->frames[regs->numFrames] = (uint16_t) (wide ? regs->DR : regs->DR & 0xFF);
+    regs->wideFrames[regs->numFrames] = wide;
+    regs->numFrames++;
+    regs->DR = kDrEmpty;
+  }
+  return 0x0002; // TXE
+}
+
+/** Stand-in for SPIClass, which is used only by begin() and end(). */
+class FakeSpi {
+  public:
+    void beginTransaction(SPISettings /*settings*/) { mNumBegins++; }
+    void endTransaction() { mNumEnds++; }
+
+    uint8_t mNumBegins = 0;
+    uint8_t mNumEnds = 0;
+};
+
+const uint8_t LATCH_PIN = 10;
+
+FakeSpi fakeSpi;
+FakeSpiRegs fakeRegs;
+
+using SpiInterface = HardSpiStm32Interface<FakeSpi, FakeSpiRegs>;
+SpiInterface spiInterface(fakeSpi, &fakeRegs, LATCH_PIN);
+
+//-----------------------------------------------------------------------------
+
+test(HardSpiStm32InterfaceTest, begin_end) {
+  fakeRegs.reset();
+  fakeSpi.mNumBegins = 0;
+  fakeSpi.mNumEnds = 0;
+
+  spiInterface.begin();
+  assertEqual(1, fakeSpi.mNumBegins);
+  assertEqual((uint32_t) 0x0040, fakeRegs.CR1); // SPE
+
+  spiInterface.end();
+  assertEqual(1, fakeSpi.mNumEnds);
+}
+
+test(HardSpiStm32InterfaceTest, send8) {
+  fakeRegs.reset();
+  spiInterface.send8(0x12);
+  assertEqual(1, fakeRegs.numFrames);
+  assertEqual(0x12, fakeRegs.frames[0]);
+  assertFalse(fakeRegs.wideFrames[0]);
+}
+
+test(HardSpiStm32InterfaceTest, send16) {
+  fakeRegs.reset();
+  spiInterface.send16(0x1234);
+  spiInterface.send16(0x56, 0x78);
+  assertEqual(4, fakeRegs.numFrames);
+  assertEqual(0x12, fakeRegs.frames[0]);
+  assertEqual(0x34, fakeRegs.frames[1]);
+  assertEqual(0x56, fakeRegs.frames[2]);
+  assertEqual(0x78, fakeRegs.frames[3]);
+}
+
+test(HardSpiStm32InterfaceTest, send_variadic) {
+  fakeRegs.reset();
+  spiInterface.send(0x01, 0x02, 0xFF);
+  assertEqual(3, fakeRegs.numFrames);
+  assertEqual(0x01, fakeRegs.frames[0]);
+  assertEqual(0x02, fakeRegs.frames[1]);
+  assertEqual(0xFF, fakeRegs.frames[2]);
+}
+
+test(HardSpiStm32InterfaceTest, sendRegisters) {
+  fakeRegs.reset();
+  const uint8_t pairs[] = {0x01, 0x11, 0x02, 0x22, 0x03, 0x33};
+  spiInterface.sendRegisters(pairs, 3, 2);
+  assertEqual(6, fakeRegs.numFrames);
+  for (uint8_t i = 0; i < 6; i++) {
+    assertEqual(pairs[i], fakeRegs.frames[i]);
+    assertFalse(fakeRegs.wideFrames[i]);
+  }
+}
+
+test(HardSpiStm32InterfaceTest, transfer16Array_uses_16_bit_frames) {
+  fakeRegs.reset();
+  fakeRegs.CR1 = 0x0040; // SPE
+  const uint16_t values[] = {0xF800, 0x07E0, 0x001F};
+
+  spiInterface.beginTransaction();
+  spiInterface.transfer(0x2C);
+  spiInterface.transfer16Array(values, 3);
+  spiInterface.transfer(0x00);
+  spiInterface.endTransaction();
+
+  assertEqual(5, fakeRegs.numFrames);
+  assertEqual(0x2C, fakeRegs.frames[0]);
+  assertFalse(fakeRegs.wideFrames[0]);
+  for (uint8_t i = 0; i < 3; i++) {
+    assertEqual(values[i], fakeRegs.frames[i + 1]);
+    assertTrue(fakeRegs.wideFrames[i + 1]);
+  }
+  assertEqual(0x00, fakeRegs.frames[4]);
+  assertFalse(fakeRegs.wideFrames[4]);
+
+  // DFF is cleared and the peripheral is enabled again.
+  assertEqual((uint32_t) 0x0040, fakeRegs.CR1);
+}
+
+//-----------------------------------------------------------------------------
+
+void setup() {
+#if ! defined(EPOXY_DUINO)
+  delay(1000); // wait to prevent garbage on SERIAL_PORT_MONITOR
+#endif
+
+  SERIAL_PORT_MONITOR.begin(115200);
+  while (!SERIAL_PORT_MONITOR); // needed for Leonardo/Micro
+}
+
+void loop() {
+  TestRunner::run();
+}
@@ -0,0 +1,156 @@
+#line 2 "PayloadPoolTest.ino"
+
+#include <AUnit.h>
+#include <AceSPI.h>
+
+using aunit::TestRunner;
+using namespace ace_spi;
+
+//-----------------------------------------------------------------------------
+
+/** An SPI interface which records the bytes of each transaction. */
+class FakeSpiInterface {
+  public:
+    void reset() const {
+      mNumBytes = 0;
+      mNumTransactions = 0;
+    }
+
+    void beginTransaction() const {}
+    void endTransaction() const { mNumTransactions++; }
+    void transfer(uint8_t value) const { mBytes[mNumBytes++] = value; }
+
+    mutable uint8_t mBytes[32];
+    mutable uint8_t mNumBytes = 0;
+    mutable uint8_t mNumTransactions = 0;
+};
+
+const uint8_t NUM_BLOCKS = 4;
+using Pool = PayloadPool<8, NUM_BLOCKS>;
+
+FakeSpiInterface spiInterface;
+
+//-----------------------------------------------------------------------------
+
+test(PayloadPoolTest, acquire_until_exhausted) {
+  Pool pool;
+  uint8_t handles[NUM_BLOCKS];
+  for (uint8_t i = 0; i < NUM_BLOCKS; i++) {
+    handles[i] = pool.acquire();
+    assertNotEqual(Pool::kNoBlock, handles[i]);
+    assertEqual(1, pool.getRefCount(handles[i]));
+    for (uint8_t j = 0; j < i; j++) {
+      assertNotEqual(handles[j], handles[i]);
+    }
+  }
+  assertEqual(0, pool.getFreeCount());
+  assertEqual(0, pool.getExhaustedCount());
+
+  // Each failed acquire() is counted.
+  assertEqual(Pool::kNoBlock, pool.acquire());
+  assertEqual(Pool::kNoBlock, pool.acquire());
+  assertEqual(2, pool.getExhaustedCount());
+
+  // A released block can be acquired again.
+  pool.release(handles[2]);
+  assertEqual(1, pool.getFreeCount());
+  assertEqual(handles[2], pool.acquire());
+  assertEqual(Pool::kNoBlock, pool.acquire());
+  assertEqual(3, pool.getExhaustedCount());
+
+  pool.reset();
+  assertEqual(NUM_BLOCKS, pool.getFreeCount());
+  assertEqual(0, pool.getExhaustedCount());
+}
+
+test(PayloadPoolTest, release_invalid_handle) {
+  Pool pool;
+  uint8_t handle = pool.acquire();
+
+  // Releasing kNoBlock or a free block does nothing.
+  pool.release(Pool::kNoBlock);
+  pool.release(handle + 1);
+  assertEqual(NUM_BLOCKS - 1, pool.getFreeCount());
+
+  // Releasing a block twice returns it to the free list only once.
+  pool.release(handle);
+  pool.release(handle);
+  assertEqual(NUM_BLOCKS, pool.getFreeCount());
+}
+
+test(PayloadPoolTest, retain_and_release) {
+  Pool pool;
+  uint8_t handle = pool.acquire();
+  assertTrue(pool.retain(handle));
+  assertTrue(pool.retain(handle));
+  assertEqual(3, pool.getRefCount(handle));
+
+  pool.release(handle);
+  pool.release(handle);
+  assertEqual(NUM_BLOCKS - 1, pool.getFreeCount());
+  pool.release(handle);
+  assertEqual(NUM_BLOCKS, pool.getFreeCount());
+
+  // A free block or kNoBlock cannot be retained.
+  assertFalse(pool.retain(handle));
+  assertFalse(pool.retain(Pool::kNoBlock));
+  assertEqual(0, pool.getRefCount(handle));
+}
+
+test(PayloadPoolTest, retain_does_not_overflow) {
+  Pool pool;
+  uint8_t handle = pool.acquire();
+  for (uint16_t i = 1; i < 255; i++) {
+    assertTrue(pool.retain(handle));
+  }
+  assertEqual(255, pool.getRefCount(handle));
+  assertFalse(pool.retain(handle));
+  assertEqual(255, pool.getRefCount(handle));
+
+  // The block is still held by the 255 references.
+  for (uint16_t i = 1; i < 255; i++) {
+    pool.release(handle);
+  }
+  assertEqual(NUM_BLOCKS - 1, pool.getFreeCount());
+  pool.release(handle);
+  assertEqual(NUM_BLOCKS, pool.getFreeCount());
+}
+
+test(PayloadPoolTest, send_and_release) {
+  Pool pool;
+  uint8_t handle = pool.acquire();
+  const uint8_t frame[] = {0x11, 0x22, 0x33};
+  memcpy(pool.getData(handle), frame, sizeof(frame));
+  pool.setLength(handle, sizeof(frame));
+  pool.retain(handle);
+
+  spiInterface.reset();
+  pool.sendAndRelease(spiInterface, handle);
+  pool.sendAndRelease(spiInterface, handle);
+  assertEqual(2, spiInterface.mNumTransactions);
+  assertEqual(6, spiInterface.mNumBytes);
+  for (uint8_t i = 0; i < 6; i++) {
+    assertEqual(frame[i % 3], spiInterface.mBytes[i]);
+  }
+  assertEqual(NUM_BLOCKS, pool.getFreeCount());
+
+  // The length is limited to the block size.
+  handle = pool.acquire();
+  pool.setLength(handle, 100);
+  assertEqual(8, pool.getLength(handle));
+}
+
+//-----------------------------------------------------------------------------
+
+void setup() {
+#if ! defined(EPOXY_DUINO)
+  delay(1000); // wait to prevent garbage on SERIAL_PORT_MONITOR
+#endif
+
+  SERIAL_PORT_MONITOR.begin(115200);
+  while (!SERIAL_PORT_MONITOR); // needed for Leonardo/Micro
+}
+
+void loop() {
+  TestRunner::run();
+}
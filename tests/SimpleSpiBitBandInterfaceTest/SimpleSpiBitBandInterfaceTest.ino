@@ -0,0 +1,199 @@
+#line 2 "SimpleSpiBitBandInterfaceTest.ino"
+
+#include <AUnit.h>
+#include <AceSPI.h>
+
+using aunit::TestRunner;
+using namespace ace_spi;
+
+//-----------------------------------------------------------------------------
+// Emulation of the bit-band alias region of a single GPIO output register.
+//-----------------------------------------------------------------------------
+
+// GPIOA_ODR of the STM32F103. SS=PA4, MOSI=PA7, SCK=PA5 on the Blue Pill.
+const uint32_t ODR_ADDRESS = 0x4001080C;
+const uint8_t LATCH_BIT = 4;
+const uint8_t CLOCK_BIT = 5;
+const uint8_t DATA_BIT = 7;
+
+/**
+ * The emulated output register, and the bytes decoded by an SPI slave
+ * attached to its pins, which samples the data pin on the rising edge of the
+ * clock pin while the latch pin is LOW.
+ */
+struct FakeGpio {
+  static void reset() {
+    odr = 0xFF;
+    numWrites = 0;
+    numBadAddresses = 0;
+    numBits = 0;
+    numBytes = 0;
+  }
+
+  static void write(uint8_t bit, uint32_t value) {
+    uint32_t old = odr;
+    // The hardware stores only bit 0 of the value.
+    if (value & 0x01) {
+      odr |= (uint32_t) 1 << bit;
+    } else {
+      odr &= ~((uint32_t) 1 << bit);
+    }
+    numWrites++;
+
+    bool risingClock = ! (old & (1 << CLOCK_BIT)) && (odr & (1 << CLOCK_BIT));
+    if (risingClock && ! (odr & (1 << LATCH_BIT))) {
+      current = (current << 1) | ((odr >> DATA_BIT) & 0x01);
+      if (++numBits == 8) {
+        bytes[numBytes++] = current;
+        numBits = 0;
+      }
+    }
+  }
+
+  static uint32_t odr;
+  static uint16_t numWrites;
+  static uint8_t numBadAddresses;
+  static uint8_t current;
+  static uint8_t numBits;
+  static uint8_t bytes[16];
+  static uint8_t numBytes;
+};
+
+uint32_t FakeGpio::odr;
+uint16_t FakeGpio::numWrites;
+uint8_t FakeGpio::numBadAddresses;
+uint8_t FakeGpio::current;
+uint8_t FakeGpio::numBits;
+uint8_t FakeGpio::bytes[16];
+uint8_t FakeGpio::numBytes;
+
+/** One 32-bit word of the alias region, which maps to one bit of the ODR. */
+struct FakeAliasWord {
+  void operator=(uint32_t value) {
+    if (bit < 32) FakeGpio::write(bit, value);
+  }
+
+  uint8_t bit;
+};
+
+/**
+ * Memory access policy for BitBandPin which maps the 32 alias words of the
+ * ODR into FakeAliasWord objects. Any other address is counted as an error.
+ */
+struct FakeBitBandMemory {
+  static FakeAliasWord* word(uint32_t address) {
+    uint32_t base = 0x42000000 + ((ODR_ADDRESS - 0x40000000) << 5);
+    uint32_t offset = address - base;
+    if (offset >= 32 * 4 || (offset & 0x03)) {
+      FakeGpio::numBadAddresses++;
+      return &badWord;
+    }
+    aliasWords[offset >> 2].bit = offset >> 2;
+    return &aliasWords[offset >> 2];
+  }
+
+  static FakeAliasWord aliasWords[32];
+  static FakeAliasWord badWord;
+};
+
+FakeAliasWord FakeBitBandMemory::aliasWords[32];
+FakeAliasWord FakeBitBandMemory::badWord = {32};
+
+using LatchPin = BitBandPin<10, ODR_ADDRESS, LATCH_BIT, FakeBitBandMemory>;
+using ClockPin = BitBandPin<13, ODR_ADDRESS, CLOCK_BIT, FakeBitBandMemory>;
+using DataPin = BitBandPin<11, ODR_ADDRESS, DATA_BIT, FakeBitBandMemory>;
+
+using SpiInterface = SimpleSpiBitBandInterface<LatchPin, DataPin, ClockPin>;
+SpiInterface spiInterface;
+
+//-----------------------------------------------------------------------------
+
+test(BitBandPinTest, alias_address) {
+  // PA5 of the STM32F103, using GPIOA_ODR.
+  assertEqual((uint32_t) 0x42210194,
+      (BitBandPin<0, 0x4001080C, 5>::kAliasAddress));
+
+  // PTC5 of the Teensy 3.2, using GPIOC_PDOR.
+  assertEqual((uint32_t) 0x43FE1014,
+      (BitBandPin<0, 0x400FF080, 5>::kAliasAddress));
+
+  // The first and last bit of the region.
+  assertEqual((uint32_t) 0x42000000,
+      (BitBandPin<0, 0x40000000, 0>::kAliasAddress));
+  assertEqual((uint32_t) 0x43FFFFFC,
+      (BitBandPin<0, 0x400FFFFC, 31>::kAliasAddress));
+}
+
+test(BitBandPinTest, write_changes_only_its_bit) {
+  FakeGpio::reset();
+
+  ClockPin::setLow();
+  assertEqual((uint32_t) 0xDF, FakeGpio::odr);
+  ClockPin::setHigh();
+  assertEqual((uint32_t) 0xFF, FakeGpio::odr);
+
+  // Only bit 0 of the value is stored.
+  DataPin::write(0x02);
+  assertEqual((uint32_t) 0x7F, FakeGpio::odr);
+  DataPin::write(0x03);
+  assertEqual((uint32_t) 0xFF, FakeGpio::odr);
+
+  // Each write is a single store.
+  assertEqual(4, FakeGpio::numWrites);
+  assertEqual(0, FakeGpio::numBadAddresses);
+}
+
+test(SimpleSpiBitBandInterfaceTest, send8) {
+  FakeGpio::reset();
+  spiInterface.send8(0xA5);
+
+  assertEqual(1, FakeGpio::numBytes);
+  assertEqual(0xA5, FakeGpio::bytes[0]);
+  assertEqual(0, FakeGpio::numBits);
+  assertEqual(0, FakeGpio::numBadAddresses);
+
+  // Latch is released at the end of the transaction.
+  assertTrue(FakeGpio::odr & (1 << LATCH_BIT));
+}
+
+test(SimpleSpiBitBandInterfaceTest, send16_and_send) {
+  FakeGpio::reset();
+  spiInterface.send16(0x1234);
+  spiInterface.send16(0x80, 0x01);
+  spiInterface.send(0x00, 0xFF);
+
+  assertEqual(6, FakeGpio::numBytes);
+  assertEqual(0x12, FakeGpio::bytes[0]);
+  assertEqual(0x34, FakeGpio::bytes[1]);
+  assertEqual(0x80, FakeGpio::bytes[2]);
+  assertEqual(0x01, FakeGpio::bytes[3]);
+  assertEqual(0x00, FakeGpio::bytes[4]);
+  assertEqual(0xFF, FakeGpio::bytes[5]);
+  assertEqual(0, FakeGpio::numBadAddresses);
+}
+
+test(SimpleSpiBitBandInterfaceTest, sendRegisters) {
+  FakeGpio::reset();
+  const uint8_t pairs[] = {0x01, 0x11, 0x02, 0x22, 0x03, 0x33};
+  spiInterface.sendRegisters(pairs, 3, 2);
+
+  assertEqual(6, FakeGpio::numBytes);
+  for (uint8_t i = 0; i < 6; i++) {
+    assertEqual(pairs[i], FakeGpio::bytes[i]);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void setup() {
+#if ! defined(EPOXY_DUINO)
+  delay(1000); // wait to prevent garbage on SERIAL_PORT_MONITOR
+#endif
+
+  SERIAL_PORT_MONITOR.begin(115200);
+  while (!SERIAL_PORT_MONITOR); // needed for Leonardo/Micro
+}
+
+void loop() {
+  TestRunner::run();
+}
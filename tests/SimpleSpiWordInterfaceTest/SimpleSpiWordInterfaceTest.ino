@@ -0,0 +1,240 @@
+#line 2 "SimpleSpiWordInterfaceTest.ino"
+
+#include <AUnit.h>
+#include <AceSPI.h>
+
+using aunit::TestRunner;
+using namespace ace_spi;
+
+//-----------------------------------------------------------------------------
+// Emulation of an SPI slave attached to 3 pins.
+//-----------------------------------------------------------------------------
+
+/**
+ * The slave samples the data pin on the rising edge of the clock pin while the
+ * latch pin is LOW, and records the bytes of each transaction. A partial byte
+ * at the end of a transaction, or a clock edge while the latch is HIGH, is an
+ * error.
+ */
+struct FakeBus {
+  static void reset() {
+    latch = 1;
+    clock = 0;
+    data = 0;
+    numBits = 0;
+    numBytes = 0;
+    numTransactions = 0;
+    numErrors = 0;
+  }
+
+  static void setLatch(uint8_t value) {
+    if (latch == 0 && value == 1) {
+      if (numBits != 0) numErrors++;
+      transactionEnds[numTransactions++] = numBytes;
+    }
+    latch = value;
+  }
+
+  static void setClock(uint8_t value) {
+    if (clock == 0 && value == 1) {
+      if (latch) {
+        numErrors++;
+      } else {
+        current = (current << 1) | data;
+        if (++numBits == 8) {
+          bytes[numBytes++] = current;
+          numBits = 0;
+        }
+      }
+    }
+    clock = value;
+  }
+
+  static uint8_t latch;
+  static uint8_t clock;
+  static uint8_t data;
+  static uint8_t current;
+  static uint8_t numBits;
+  static uint8_t bytes[64];
+  static uint8_t numBytes;
+  static uint8_t transactionEnds[16];
+  static uint8_t numTransactions;
+  static uint8_t numErrors;
+};
+
+uint8_t FakeBus::latch;
+uint8_t FakeBus::clock;
+uint8_t FakeBus::data;
+uint8_t FakeBus::current;
+uint8_t FakeBus::numBits;
+uint8_t FakeBus::bytes[64];
+uint8_t FakeBus::numBytes;
+uint8_t FakeBus::transactionEnds[16];
+uint8_t FakeBus::numTransactions;
+uint8_t FakeBus::numErrors;
+
+class FakeLatchPin {
+  public:
+    static void setOutput() {}
+    static void setInput() {}
+    static void setHigh() { FakeBus::setLatch(1); }
+    static void setLow() { FakeBus::setLatch(0); }
+    static void write(uint8_t bit) { FakeBus::setLatch(bit & 0x01); }
+};
+
+class FakeClockPin {
+  public:
+    static void setOutput() {}
+    static void setInput() {}
+    static void setHigh() { FakeBus::setClock(1); }
+    static void setLow() { FakeBus::setClock(0); }
+    static void write(uint8_t bit) { FakeBus::setClock(bit & 0x01); }
+};
+
+class FakeDataPin {
+  public:
+    static void setOutput() {}
+    static void setInput() {}
+    static void setHigh() { FakeBus::data = 1; }
+    static void setLow() { FakeBus::data = 0; }
+    static void write(uint8_t bit) { FakeBus::data = bit & 0x01; }
+};
+
+using SpiInterface =
+    SimpleSpiWordInterface<FakeLatchPin, FakeDataPin, FakeClockPin>;
+SpiInterface spiInterface;
+
+/** Return the number of bytes received, and check that nothing went wrong. */
+static uint8_t numBytes() {
+  return (FakeBus::numErrors == 0) ? FakeBus::numBytes : 0xFF;
+}
+
+//-----------------------------------------------------------------------------
+
+test(SimpleSpiWordInterfaceTest, transfer_widths) {
+  FakeBus::reset();
+  spiInterface.beginTransaction();
+  spiInterface.transfer(0x81);
+  spiInterface.transfer16(0x1234);
+  spiInterface.transfer32(0xDEADBEEF);
+  spiInterface.endTransaction();
+
+  assertEqual(7, numBytes());
+  const uint8_t expected[] = {0x81, 0x12, 0x34, 0xDE, 0xAD, 0xBE, 0xEF};
+  for (uint8_t i = 0; i < sizeof(expected); i++) {
+    assertEqual(expected[i], FakeBus::bytes[i]);
+  }
+  assertEqual(1, FakeBus::numTransactions);
+}
+
+test(SimpleSpiWordInterfaceTest, transferArray_all_remainders) {
+  const uint8_t data[] = {
+    0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF, 0xF0
+  };
+
+  // Each length from 0 to 9 exercises the full words and every remainder.
+  for (uint8_t count = 0; count <= sizeof(data); count++) {
+    FakeBus::reset();
+    spiInterface.beginTransaction();
+    spiInterface.transferArray(data, count);
+    spiInterface.endTransaction();
+
+    assertEqual(count, numBytes());
+    for (uint8_t i = 0; i < count; i++) {
+      assertEqual(data[i], FakeBus::bytes[i]);
+    }
+  }
+}
+
+test(SimpleSpiWordInterfaceTest, transferWords) {
+  FakeBus::reset();
+  const uint32_t words[] = {0x00010203, 0x80FF7F01};
+  spiInterface.beginTransaction();
+  spiInterface.transferWords(words, 2);
+  spiInterface.endTransaction();
+
+  assertEqual(8, numBytes());
+  const uint8_t expected[] = {0x00, 0x01, 0x02, 0x03, 0x80, 0xFF, 0x7F, 0x01};
+  for (uint8_t i = 0; i < sizeof(expected); i++) {
+    assertEqual(expected[i], FakeBus::bytes[i]);
+  }
+}
+
+test(SimpleSpiWordInterfaceTest, transfer16Array_odd_count) {
+  FakeBus::reset();
+  const uint16_t values[] = {0xF800, 0x07E0, 0x001F};
+  spiInterface.beginTransaction();
+  spiInterface.transfer16Array(values, 3);
+  spiInterface.endTransaction();
+
+  assertEqual(6, numBytes());
+  const uint8_t expected[] = {0xF8, 0x00, 0x07, 0xE0, 0x00, 0x1F};
+  for (uint8_t i = 0; i < sizeof(expected); i++) {
+    assertEqual(expected[i], FakeBus::bytes[i]);
+  }
+}
+
+test(SimpleSpiWordInterfaceTest, send8_send16_send) {
+  FakeBus::reset();
+  spiInterface.send8(0x5A);
+  spiInterface.send16(0xA55A);
+  spiInterface.send16(0x12, 0x34);
+  spiInterface.send(0x01, 0x02, 0x03);
+
+  assertEqual(8, numBytes());
+  const uint8_t expected[] = {0x5A, 0xA5, 0x5A, 0x12, 0x34, 0x01, 0x02, 0x03};
+  for (uint8_t i = 0; i < sizeof(expected); i++) {
+    assertEqual(expected[i], FakeBus::bytes[i]);
+  }
+  assertEqual(4, FakeBus::numTransactions);
+  assertEqual(1, FakeBus::transactionEnds[0]);
+  assertEqual(3, FakeBus::transactionEnds[1]);
+  assertEqual(5, FakeBus::transactionEnds[2]);
+  assertEqual(8, FakeBus::transactionEnds[3]);
+}
+
+test(SimpleSpiWordInterfaceTest, sendRegisters) {
+  FakeBus::reset();
+  const uint8_t pairs[] = {
+    0x01, 0x11, 0x02, 0x22, 0x03, 0x33, 0x04, 0x44, 0x05, 0x55
+  };
+  spiInterface.sendRegisters(pairs, 5, 2);
+
+  assertEqual(10, numBytes());
+  for (uint8_t i = 0; i < sizeof(pairs); i++) {
+    assertEqual(pairs[i], FakeBus::bytes[i]);
+  }
+  assertEqual(3, FakeBus::numTransactions);
+  assertEqual(4, FakeBus::transactionEnds[0]);
+  assertEqual(8, FakeBus::transactionEnds[1]);
+  assertEqual(10, FakeBus::transactionEnds[2]);
+}
+
+test(SimpleSpiWordInterfaceTest, sendGenerated) {
+  for (uint8_t count = 0; count <= 9; count++) {
+    FakeBus::reset();
+    uint8_t next = 0xF0;
+    spiInterface.sendGenerated([&next]() { return next++; }, count);
+
+    assertEqual(count, numBytes());
+    for (uint8_t i = 0; i < count; i++) {
+      assertEqual((uint8_t) (0xF0 + i), FakeBus::bytes[i]);
+    }
+    assertEqual(1, FakeBus::numTransactions);
+  }
+}
+
+//-----------------------------------------------------------------------------
+
+void setup() {
+#if ! defined(EPOXY_DUINO)
+  delay(1000); // wait to prevent garbage on SERIAL_PORT_MONITOR
+#endif
+
+  SERIAL_PORT_MONITOR.begin(115200);
+  while (!SERIAL_PORT_MONITOR); // needed for Leonardo/Micro
+}
+
+void loop() {
+  TestRunner::run();
+}
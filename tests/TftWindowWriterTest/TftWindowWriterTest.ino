@@ -0,0 +1,298 @@
+#line 2 "TftWindowWriterTest.ino"
+
+#include <AUnit.h>
+#include <AceSPI.h>
+
+using aunit::TestRunner;
+using namespace ace_spi;
+
+//-----------------------------------------------------------------------------
+// Emulation of a small TFT controller with the MIPI DCS command set.
+//-----------------------------------------------------------------------------
+
+const uint8_t TFT_WIDTH = 8;
+const uint8_t TFT_HEIGHT = 6;
+
+/**
+ * The controller decodes the bytes received in each transaction. A byte sent
+ * while D/C is LOW is a command. CASET and RASET take two 16-bit big-endian
+ * parameters. RAMWR moves the write pointer to the top-left corner of the
+ * window, then writes each 16-bit pixel at the pointer, which advances through
+ * the window and wraps around to its first row.
+ */
+struct FakeTft {
+  static void reset() {
+    for (uint8_t y = 0; y < TFT_HEIGHT; y++) {
+      for (uint8_t x = 0; x < TFT_WIDTH; x++) {
+        frame[y][x] = 0;
+      }
+    }
+    command = 0;
+    numParams = 0;
+    x0 = x1 = y0 = y1 = 0;
+    x = y = 0;
+    numWindows = 0;
+    numCommands = 0;
+    numErrors = 0;
+  }
+
+  static void receive(uint8_t value) {
+    if (! selected) numErrors++;
+    if (dc == 0) {
+      command = value;
+      numParams = 0;
+      numCommands++;
+      if (command == 0x2C) { // RAMWR
+        x = x0;
+        y = y0;
+        numWindows++;
+      }
+      return;
+    }
+
+    params[numParams & 0x03] = value;
+    numParams++;
+    if (command == 0x2A && numParams == 4) { // CASET
+      x0 = (params[0] << 8) | params[1];
+      x1 = (params[2] << 8) | params[3];
+    } else if (command == 0x2B && numParams == 4) { // RASET
+      y0 = (params[0] << 8) | params[1];
+      y1 = (params[2] << 8) | params[3];
+    } else if (command == 0x2C && (numParams & 0x01) == 0) {
+      writePixel((params[(numParams - 2) & 0x03] << 8) | value);
+    }
+  }
+
+  static void writePixel(uint16_t pixel) {
+    if (x < TFT_WIDTH && y < TFT_HEIGHT) {
+      frame[y][x] = pixel;
+    } else {
+      numErrors++;
+    }
+    if (++x > x1) {
+      x = x0;
+      if (++y > y1) y = y0;
+    }
+  }
+
+  static uint16_t frame[TFT_HEIGHT][TFT_WIDTH];
+  static bool selected;
+  static uint8_t dc;
+  static uint8_t command;
+  static uint8_t params[4];
+  static uint16_t numParams;
+  static uint16_t x0, x1, y0, y1;
+  static uint16_t x, y;
+  static uint8_t numWindows;
+  static uint8_t numCommands;
+  static uint8_t numErrors;
+};
+
+uint16_t FakeTft::frame[TFT_HEIGHT][TFT_WIDTH];
+bool FakeTft::selected;
+uint8_t FakeTft::dc = 1;
+uint8_t FakeTft::command;
+uint8_t FakeTft::params[4];
+uint16_t FakeTft::numParams;
+uint16_t FakeTft::x0, FakeTft::x1, FakeTft::y0, FakeTft::y1;
+uint16_t FakeTft::x, FakeTft::y;
+uint8_t FakeTft::numWindows;
+uint8_t FakeTft::numCommands;
+uint8_t FakeTft::numErrors;
+
+/** An SPI interface which delivers each byte to the FakeTft. */
+class FakeSpiInterface {
+  public:
+    void beginTransaction() const { FakeTft::selected = true; }
+    void endTransaction() const { FakeTft::selected = false; }
+
+    void transfer(uint8_t value) const { FakeTft::receive(value); }
+
+    void transfer16(uint16_t value) const {
+      FakeTft::receive(value >> 8);
+      FakeTft::receive(value);
+    }
+
+    void transfer16Array(const uint16_t* values, uint16_t count) const {
+      for (uint16_t i = 0; i < count; i++) {
+        transfer16(values[i]);
+      }
+    }
+};
+
+/** Pin policy of the D/C pin of the FakeTft. */
+class FakeDcPin {
+  public:
+    static void setOutput() {}
+    static void setInput() {}
+    static void setHigh() { FakeTft::dc = 1; }
+    static void setLow() { FakeTft::dc = 0; }
+};
+
+FakeSpiInterface spiInterface;
+TftWindowWriter<FakeSpiInterface, FakeDcPin> writer(spiInterface, TFT_HEIGHT);
+
+/** Pixel value which encodes its own coordinates. */
+static uint16_t pixelAt(uint8_t x, uint8_t y) {
+  return 0x8000 | (y << 8) | x;
+}
+
+/** Fill `pixels` with the pixelAt() values of the given rectangle. */
+static void fillRect(uint16_t* pixels,
+    uint8_t x, uint8_t y, uint8_t width, uint8_t height) {
+  for (uint8_t j = 0; j < height; j++) {
+    for (uint8_t i = 0; i < width; i++) {
+      *pixels++ = pixelAt(x + i, y + j);
+    }
+  }
+}
+
+/** Reset the controller and the writer. */
+static void beginTest() {
+  FakeTft::reset();
+  writer.begin();
+  writer.resetWindowCount();
+}
+
+//-----------------------------------------------------------------------------
+
+test(TftWindowWriterTest, writePixels_rectangle) {
+  beginTest();
+  uint16_t pixels[3 * 2];
+  fillRect(pixels, 2, 1, 3, 2);
+  writer.writePixels(2, 1, 3, 2, pixels);
+
+  assertEqual(1, writer.getWindowCount());
+  assertEqual(1, FakeTft::numWindows);
+  assertEqual(0, FakeTft::numErrors);
+  for (uint8_t y = 0; y < TFT_HEIGHT; y++) {
+    for (uint8_t x = 0; x < TFT_WIDTH; x++) {
+      bool inside = (x >= 2 && x < 5 && y >= 1 && y < 3);
+      assertEqual(inside ? pixelAt(x, y) : 0, FakeTft::frame[y][x]);
+    }
+  }
+
+  // The window is opened down to the last row.
+  assertEqual(2, FakeTft::x0);
+  assertEqual(4, FakeTft::x1);
+  assertEqual(1, FakeTft::y0);
+  assertEqual(TFT_HEIGHT - 1, FakeTft::y1);
+}
+
+test(TftWindowWriterTest, sequential_rows_share_window) {
+  beginTest();
+  uint16_t row[TFT_WIDTH];
+  for (uint8_t y = 0; y < TFT_HEIGHT; y++) {
+    fillRect(row, 0, y, TFT_WIDTH, 1);
+    writer.writePixels(0, y, TFT_WIDTH, 1, row);
+  }
+
+  assertEqual(1, writer.getWindowCount());
+  assertEqual(1, FakeTft::numWindows);
+  assertEqual(0, FakeTft::numErrors);
+  for (uint8_t y = 0; y < TFT_HEIGHT; y++) {
+    for (uint8_t x = 0; x < TFT_WIDTH; x++) {
+      assertEqual(pixelAt(x, y), FakeTft::frame[y][x]);
+    }
+  }
+}
+
+test(TftWindowWriterTest, continued_row_shares_window) {
+  beginTest();
+  uint16_t pixels[TFT_WIDTH];
+  fillRect(pixels, 0, 1, TFT_WIDTH, 1);
+  writer.writePixels(0, 1, TFT_WIDTH, 1, pixels);
+
+  // Pieces of the next row, within the columns of the window.
+  fillRect(pixels, 0, 2, 3, 1);
+  writer.writePixels(0, 2, 3, 1, pixels);
+  fillRect(pixels, 3, 2, 5, 1);
+  writer.writePixels(3, 2, 5, 1, pixels);
+
+  assertEqual(1, writer.getWindowCount());
+  assertEqual(0, FakeTft::numErrors);
+  for (uint8_t x = 0; x < TFT_WIDTH; x++) {
+    assertEqual(pixelAt(x, 2), FakeTft::frame[2][x]);
+  }
+
+  // A piece which does not start at the write pointer.
+  fillRect(pixels, 1, 3, 2, 1);
+  writer.writePixels(1, 3, 2, 1, pixels);
+  assertEqual(2, writer.getWindowCount());
+}
+
+test(TftWindowWriterTest, disjoint_rectangles_send_window) {
+  beginTest();
+  uint16_t pixels[4];
+  fillRect(pixels, 0, 0, 2, 2);
+  writer.writePixels(0, 0, 2, 2, pixels);
+  fillRect(pixels, 5, 3, 2, 2);
+  writer.writePixels(5, 3, 2, 2, pixels);
+
+  // Same columns, but a different start row.
+  fillRect(pixels, 5, 0, 2, 1);
+  writer.writePixels(5, 0, 2, 1, pixels);
+
+  assertEqual(3, writer.getWindowCount());
+  assertEqual(3, FakeTft::numWindows);
+  assertEqual(pixelAt(1, 1), FakeTft::frame[1][1]);
+  assertEqual(pixelAt(6, 4), FakeTft::frame[4][6]);
+  assertEqual(pixelAt(6, 0), FakeTft::frame[0][6]);
+  assertEqual(0, FakeTft::frame[2][5]);
+  assertEqual(0, FakeTft::numErrors);
+}
+
+test(TftWindowWriterTest, wrap_around_sends_window) {
+  beginTest();
+  uint16_t row[TFT_WIDTH];
+  fillRect(row, 0, TFT_HEIGHT - 1, TFT_WIDTH, 1);
+  writer.writePixels(0, TFT_HEIGHT - 1, TFT_WIDTH, 1, row);
+
+  // The controller wrapped around to row TFT_HEIGHT - 1, not row 0.
+  fillRect(row, 0, 0, TFT_WIDTH, 1);
+  writer.writePixels(0, 0, TFT_WIDTH, 1, row);
+
+  assertEqual(2, writer.getWindowCount());
+  assertEqual(pixelAt(0, 0), FakeTft::frame[0][0]);
+  assertEqual(pixelAt(7, TFT_HEIGHT - 1), FakeTft::frame[TFT_HEIGHT - 1][7]);
+}
+
+test(TftWindowWriterTest, sendCommand_invalidates_window) {
+  beginTest();
+  uint16_t pixels[2];
+  fillRect(pixels, 0, 0, 2, 1);
+  writer.writePixels(0, 0, 2, 1, pixels);
+
+  const uint8_t params[] = {0x00, 0x00, 0x00, 0x03};
+  writer.sendCommand(0x2A, params, sizeof(params));
+  assertEqual(0x2A, FakeTft::command);
+  assertEqual(3, FakeTft::x1);
+
+  // The next rectangle continues the row, but the window is sent again.
+  fillRect(pixels, 2, 0, 2, 1);
+  writer.writePixels(2, 0, 2, 1, pixels);
+  assertEqual(2, writer.getWindowCount());
+  assertEqual(pixelAt(3, 0), FakeTft::frame[0][3]);
+
+  // As does invalidate().
+  writer.invalidate();
+  fillRect(pixels, 4, 0, 2, 1);
+  writer.writePixels(4, 0, 2, 1, pixels);
+  assertEqual(3, writer.getWindowCount());
+  assertEqual(0, FakeTft::numErrors);
+}
+
+//-----------------------------------------------------------------------------
+
+void setup() {
+#if ! defined(EPOXY_DUINO)
+  delay(1000); // wait to prevent garbage on SERIAL_PORT_MONITOR
+#endif
+
+  SERIAL_PORT_MONITOR.begin(115200);
+  while (!SERIAL_PORT_MONITOR); // needed for Leonardo/Micro
+}
+
+void loop() {
+  TestRunner::run();
+}
@@ -0,0 +1,197 @@
+#line 2 "UsiSpiInterfaceTest.ino"
+
+#include <AUnit.h>
+#include <AceSPI.h>
+
+using aunit::TestRunner;
+using namespace ace_spi;
+
+//-----------------------------------------------------------------------------
+// Emulation of the USI of the ATtiny25/45/85 in three-wire mode.
+//-----------------------------------------------------------------------------
+
+/**
+ * Register access policy which emulates the USI shift register, the USCK pin,
+ * and the latch pin, and decodes the bits received by the slave device. Each
+ * write to USICR with USITC toggles USCK. The slave samples DO (bit 7 of USIDR)
+ * on the rising edge of USCK. A write with USICLK shifts USIDR left by 1 bit.
+ */
+struct FakeUsiRegisters {
+  static void reset() {
+    usidr = 0;
+    usck = 0;
+    latch = 1;
+    outputs = false;
+    numStrobes = 0;
+    numBits = 0;
+    numBytes = 0;
+    numTransactions = 0;
+    numErrors = 0;
+  }
+
+  static void setUsidr(uint8_t value) { usidr = value; }
+
+  static void setUsicr(uint8_t value) {
+    numStrobes++;
+    if (value & 0x01) { // USITC
+      usck ^= 1;
+      if (usck) {
+        // The slave samples DO only while it is selected.
+        if (latch || ! outputs) numErrors++;
+        current = (current << 1) | (usidr >> 7);
+        if (++numBits == 8) {
+          bytes[numBytes++] = current;
+          numBits = 0;
+        }
+      }
+    }
+    if (value & 0x02) usidr <<= 1; // USICLK
+  }
+
+  static void enableOutputs() { outputs = true; }
+  static void disableOutputs() { outputs = false; }
+
+  static void setLatchOutput(uint8_t /*bit*/) {}
+  static void setLatchInput(uint8_t /*bit*/) {}
+  static void setLatchLow(uint8_t /*bit*/) { latch = 0; }
+
+  static void setLatchHigh(uint8_t /*bit*/) {
+    // A partial byte at the end of a transaction is an error.
+    if (latch == 0) {
+      numTransactions++;
+      if (numBits != 0) numErrors++;
+    }
+    latch = 1;
+  }
+
+  static uint8_t usidr;
+  static uint8_t usck;
+  static uint8_t latch;
+  static bool outputs;
+  static uint16_t numStrobes;
+  static uint8_t current;
+  static uint8_t numBits;
+  static uint8_t bytes[32];
+  static uint8_t numBytes;
+  static uint8_t numTransactions;
+  static uint8_t numErrors;
+};
+
+uint8_t FakeUsiRegisters::usidr;
+uint8_t FakeUsiRegisters::usck;
+uint8_t FakeUsiRegisters::latch;
+bool FakeUsiRegisters::outputs;
+uint16_t FakeUsiRegisters::numStrobes;
+uint8_t FakeUsiRegisters::current;
+uint8_t FakeUsiRegisters::numBits;
+uint8_t FakeUsiRegisters::bytes[32];
+uint8_t FakeUsiRegisters::numBytes;
+uint8_t FakeUsiRegisters::numTransactions;
+uint8_t FakeUsiRegisters::numErrors;
+
+using Regs = FakeUsiRegisters;
+using SpiInterface = UsiSpiInterface<3, Regs>;
+SpiInterface spiInterface;
+
+/** Reset the emulated registers, then call begin(). */
+static void beginTest() {
+  Regs::reset();
+  spiInterface.begin();
+}
+
+//-----------------------------------------------------------------------------
+
+test(UsiSpiInterfaceTest, begin_end) {
+  Regs::reset();
+  spiInterface.begin();
+  assertTrue(Regs::outputs);
+  assertEqual(1, Regs::latch);
+
+  spiInterface.end();
+  assertFalse(Regs::outputs);
+}
+
+test(UsiSpiInterfaceTest, send8_uses_16_strobes) {
+  beginTest();
+  spiInterface.send8(0xA5);
+
+  assertEqual(16, Regs::numStrobes);
+  assertEqual(1, Regs::numBytes);
+  assertEqual(0xA5, Regs::bytes[0]);
+  assertEqual(1, Regs::numTransactions);
+  assertEqual(0, Regs::numErrors);
+
+  // USCK returns to LOW (MODE0) after each byte.
+  assertEqual(0, Regs::usck);
+}
+
+test(UsiSpiInterfaceTest, send16_msb_first) {
+  beginTest();
+  spiInterface.send16(0x1234);
+  spiInterface.send16(0x80, 0x01);
+
+  assertEqual(4, Regs::numBytes);
+  assertEqual(0x12, Regs::bytes[0]);
+  assertEqual(0x34, Regs::bytes[1]);
+  assertEqual(0x80, Regs::bytes[2]);
+  assertEqual(0x01, Regs::bytes[3]);
+  assertEqual(2, Regs::numTransactions);
+  assertEqual(0, Regs::numErrors);
+}
+
+test(UsiSpiInterfaceTest, send_variadic) {
+  beginTest();
+  spiInterface.send(0x00, 0xFF, 0x55, 0xAA);
+
+  assertEqual(4 * 16, Regs::numStrobes);
+  assertEqual(4, Regs::numBytes);
+  assertEqual(0x00, Regs::bytes[0]);
+  assertEqual(0xFF, Regs::bytes[1]);
+  assertEqual(0x55, Regs::bytes[2]);
+  assertEqual(0xAA, Regs::bytes[3]);
+  assertEqual(1, Regs::numTransactions);
+  assertEqual(0, Regs::numErrors);
+}
+
+test(UsiSpiInterfaceTest, sendRegisters) {
+  beginTest();
+  const uint8_t pairs[] = {0x01, 0x11, 0x02, 0x22, 0x03, 0x33};
+  spiInterface.sendRegisters(pairs, 3, 2);
+
+  assertEqual(6, Regs::numBytes);
+  for (uint8_t i = 0; i < 6; i++) {
+    assertEqual(pairs[i], Regs::bytes[i]);
+  }
+  assertEqual(2, Regs::numTransactions);
+  assertEqual(0, Regs::numErrors);
+}
+
+test(UsiSpiInterfaceTest, transfer16Array) {
+  beginTest();
+  const uint16_t values[] = {0xF800, 0x07E0};
+  spiInterface.beginTransaction();
+  spiInterface.transfer16Array(values, 2);
+  spiInterface.endTransaction();
+
+  assertEqual(4, Regs::numBytes);
+  assertEqual(0xF8, Regs::bytes[0]);
+  assertEqual(0x00, Regs::bytes[1]);
+  assertEqual(0x07, Regs::bytes[2]);
+  assertEqual(0xE0, Regs::bytes[3]);
+  assertEqual(0, Regs::numErrors);
+}
+
+//-----------------------------------------------------------------------------
+
+void setup() {
+#if ! defined(EPOXY_DUINO)
+  delay(1000); // wait to prevent garbage on SERIAL_PORT_MONITOR
+#endif
+
+  SERIAL_PORT_MONITOR.begin(115200);
+  while (!SERIAL_PORT_MONITOR); // needed for Leonardo/Micro
+}
+
+void loop() {
+  TestRunner::run();
+}
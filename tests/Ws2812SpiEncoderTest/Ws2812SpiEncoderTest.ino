@@ -0,0 +1,187 @@
+#line 2 "Ws2812SpiEncoderTest.ino"
+
+#include <AUnit.h>
+#include <AceSPI.h>
+
+using aunit::TestRunner;
+using namespace ace_spi;
+
+//-----------------------------------------------------------------------------
+// Decoder of the WS2812 bitstream on the MOSI pin. Ws2812SpiEncoder does not
+// compile on a 16 MHz AVR (see its static_assert), so this test runs on
+// EpoxyDuino and on 32-bit boards.
+//-----------------------------------------------------------------------------
+
+const uint8_t MAX_LEDS = 10;
+const uint16_t MAX_SPI_BYTES = MAX_LEDS * 3 * 4;
+
+/** An SPI interface which records the bytes sent on MOSI. */
+class FakeSpiInterface {
+  public:
+    void reset() const {
+      mNumBytes = 0;
+      mNumTransactions = 0;
+    }
+
+    void beginTransaction() const {}
+    void endTransaction() const { mNumTransactions++; }
+
+    void transfer(uint8_t value) const {
+      if (mNumBytes < MAX_SPI_BYTES) mBytes[mNumBytes] = value;
+      mNumBytes++;
+    }
+
+    void transfer16(uint16_t value) const {
+      transfer(value >> 8);
+      transfer(value);
+    }
+
+    void transfer16Array(const uint16_t* values, uint16_t count) const {
+      for (uint16_t i = 0; i < count; i++) {
+        transfer16(values[i]);
+      }
+    }
+
+    mutable uint8_t mBytes[MAX_SPI_BYTES];
+    mutable uint16_t mNumBytes = 0;
+    mutable uint8_t mNumTransactions = 0;
+};
+
+/**
+ * Decode the WS2812 bits of `numBytes` SPI bytes, made of symbols of
+ * T_BITS_PER_SYMBOL bits, into `colors`. Return the number of color bytes, or
+ * -1 if a symbol is invalid or the stream ends with a partial color byte.
+ */
+template <uint8_t T_BITS_PER_SYMBOL>
+int decode(const uint8_t* bytes, uint16_t numBytes, uint8_t* colors) {
+  using Symbols = Ws2812Symbols<T_BITS_PER_SYMBOL>;
+  uint16_t numBits = numBytes * 8;
+  uint8_t color = 0;
+  uint8_t numColorBits = 0;
+  int numColors = 0;
+  for (uint16_t i = 0; i + T_BITS_PER_SYMBOL <= numBits;
+      i += T_BITS_PER_SYMBOL) {
+    uint8_t symbol = 0;
+    for (uint8_t k = 0; k < T_BITS_PER_SYMBOL; k++) {
+      uint16_t p = i + k;
+      symbol = (symbol << 1) | ((bytes[p / 8] >> (7 - p % 8)) & 0x01);
+    }
+    uint8_t bit;
+    if (symbol == Symbols::kOne) {
+      bit = 1;
+    } else if (symbol == Symbols::kZero) {
+      bit = 0;
+    } else {
+      return -1;
+    }
+    color = (color << 1) | bit;
+    if (++numColorBits == 8) {
+      colors[numColors++] = color;
+      numColorBits = 0;
+    }
+  }
+  if (numBits % T_BITS_PER_SYMBOL != 0 || numColorBits != 0) return -1;
+  return numColors;
+}
+
+FakeSpiInterface spiInterface;
+
+/** Pseudo-random RGB pixels. */
+uint8_t rgb[MAX_LEDS * 3];
+
+static void fillPixels(uint8_t seed) {
+  for (uint8_t i = 0; i < MAX_LEDS * 3; i++) {
+    rgb[i] = (uint8_t) (seed + i * 37 + (i >> 2));
+  }
+}
+
+/**
+ * Send 0 to MAX_LEDS pixels using show() of the given encoder, decode the
+ * bitstream, and verify the (green, red, blue) order. Return true if all
+ * pixels match.
+ */
+template <uint8_t T_BITS_PER_SYMBOL, uint8_t T_CHUNK_SIZE>
+bool verifyShow() {
+  using Encoder =
+      Ws2812SpiEncoder<FakeSpiInterface, T_BITS_PER_SYMBOL, T_CHUNK_SIZE>;
+  Encoder encoder(spiInterface);
+  uint8_t colors[MAX_LEDS * 3];
+
+  for (uint8_t numLeds = 0; numLeds <= MAX_LEDS; numLeds++) {
+    fillPixels(numLeds);
+    spiInterface.reset();
+    encoder.show(rgb, numLeds);
+
+    if (spiInterface.mNumTransactions != 1) return false;
+    if (spiInterface.mNumBytes != numLeds * 3 * T_BITS_PER_SYMBOL) {
+      return false;
+    }
+    int numColors = decode<T_BITS_PER_SYMBOL>(
+        spiInterface.mBytes, spiInterface.mNumBytes, colors);
+    if (numColors != numLeds * 3) return false;
+    for (uint8_t i = 0; i < numLeds; i++) {
+      if (colors[3 * i] != rgb[3 * i + 1]) return false;
+      if (colors[3 * i + 1] != rgb[3 * i]) return false;
+      if (colors[3 * i + 2] != rgb[3 * i + 2]) return false;
+    }
+  }
+  return true;
+}
+
+/** Verify that encodeBytes() produces the color bytes in the same order. */
+template <uint8_t T_BITS_PER_SYMBOL>
+bool verifyEncodeBytes() {
+  using Encoder = Ws2812SpiEncoder<FakeSpiInterface, T_BITS_PER_SYMBOL>;
+  uint8_t out[MAX_SPI_BYTES];
+  uint8_t colors[MAX_LEDS * 3];
+
+  fillPixels(0x5A);
+  uint16_t numBytes = Encoder::encodeBytes(rgb, MAX_LEDS * 3, out);
+  if (numBytes != MAX_LEDS * 3 * T_BITS_PER_SYMBOL) return false;
+  int numColors = decode<T_BITS_PER_SYMBOL>(out, numBytes, colors);
+  if (numColors != MAX_LEDS * 3) return false;
+  return memcmp(colors, rgb, MAX_LEDS * 3) == 0;
+}
+
+//-----------------------------------------------------------------------------
+
+test(Ws2812SpiEncoderTest, expandSwar_matches_expandTable) {
+  using Encoder3 = Ws2812SpiEncoder<FakeSpiInterface, 3>;
+  using Encoder4 = Ws2812SpiEncoder<FakeSpiInterface, 4>;
+  for (uint16_t i = 0; i < 256; i++) {
+    assertEqual(Encoder3::expandTable(i), Encoder3::expandSwar(i));
+    assertEqual(Encoder4::expandTable(i), Encoder4::expandSwar(i));
+  }
+  assertEqual((uint32_t) 0x888888EE, Encoder4::expandTable(0x03));
+  assertEqual((uint32_t) 0x00924936, Encoder3::expandTable(0x03));
+}
+
+test(Ws2812SpiEncoderTest, show_4_bit_symbols) {
+  assertTrue((verifyShow<4, 6>()));
+  assertTrue((verifyShow<4, 1>()));
+}
+
+test(Ws2812SpiEncoderTest, show_3_bit_symbols) {
+  assertTrue((verifyShow<3, 6>()));
+  assertTrue((verifyShow<3, 1>()));
+}
+
+test(Ws2812SpiEncoderTest, encodeBytes) {
+  assertTrue(verifyEncodeBytes<4>());
+  assertTrue(verifyEncodeBytes<3>());
+}
+
+//-----------------------------------------------------------------------------
+
+void setup() {
+#if ! defined(EPOXY_DUINO)
+  delay(1000); // wait to prevent garbage on SERIAL_PORT_MONITOR
+#endif
+
+  SERIAL_PORT_MONITOR.begin(115200);
+  while (!SERIAL_PORT_MONITOR); // needed for Leonardo/Micro
+}
+
+void loop() {
+  TestRunner::run();
+}